@@ -34,6 +34,12 @@
 #define BSP_CONFIG_DCACHE_LINE_BYTES                   (1 << BSP_CONFIG_DCACHE_LINE_OFFSET)
 #define BSP_CONFIG_DCACHE_INVALIDATE_LINE_IS_SUPPORTED 1
 #define BSP_CONFIG_DCACHE_PREFETCH_LINE_IS_SUPPORTED   1
+#define BSP_CONFIG_DCACHE_CLEAN_LINE_IS_SUPPORTED      1
+#ifndef BSP_CMO_DISABLE
+#define BSP_CONFIG_DCACHE_ZERO_LINE_IS_SUPPORTED       1
+#else
+#define BSP_CONFIG_DCACHE_ZERO_LINE_IS_SUPPORTED       0
+#endif
 
 static inline void bsp_icache_enable()
 {
@@ -63,6 +69,13 @@ static inline void bsp_dcache_invalidate()
 #endif
 }
 
+static inline void bsp_dcache_clean()
+{
+#ifndef BSP_CMO_DISABLE
+    cmo_clean_all();
+#endif
+}
+
 static inline void bsp_icache_invalidate_address(uintptr_t addr)
 {
     bsp_icache_invalidate();
@@ -75,6 +88,20 @@ static inline void bsp_dcache_invalidate_address(uintptr_t addr)
 #endif
 }
 
+static inline void bsp_dcache_clean_address(uintptr_t addr)
+{
+#ifndef BSP_CMO_DISABLE
+    cmo_clean(addr);
+#endif
+}
+
+static inline void bsp_dcache_zero_address(uintptr_t addr)
+{
+#ifndef BSP_CMO_DISABLE
+    cmo_zero(addr);
+#endif
+}
+
 static inline void bsp_icache_prefetch_address(uintptr_t addr)
 {
 }
@@ -4,6 +4,12 @@
 #define BSP_CONFIG_HARTID_BITS 8
 #define BSP_CONFIG_NCPUS       1
 
+/*
+ *  Cluster of each logical CPU (initializer list indexed by the logical ID).
+ *  CPUs of the same cluster share an L2 cache slice.
+ */
+#define BSP_CONFIG_CPU_CLUSTERS { 0 }
+
 #ifndef BSP_CONFIG_HARTID_BOOT
 #define BSP_CONFIG_HARTID_BOOT 0
 #endif
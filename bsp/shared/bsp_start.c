@@ -28,13 +28,18 @@
 #include "common/compiler.h"
 #include "common/cpu.h"
 #include "common/cpu_defs.h"
+#include "common/percpu.h"
 #include "common/threads.h"
+#include "common/tls.h"
+#include "common/uthread.h"
 
 extern void __libc_init_array();
 extern void bsp_init();
 extern int main();
 extern uintptr_t _sbss;
 extern uintptr_t _ebss;
+extern uintptr_t _sbss_cached;
+extern uintptr_t _ebss_cached;
 
 //
 //  Wait for a software inter-processor interrupt
@@ -84,6 +89,22 @@ static void bsp_primary_start()
     uintptr_t bss_bytes = (uintptr_t)&_ebss - (uintptr_t)&_sbss;
     if (bss_bytes > 0) memset((void*)&_sbss, 0, bss_bytes);
 
+    //  Initialize the cached BSS data section. Write it back to memory, so
+    //  that other CPUs read zeros even with no hardware cache coherency.
+    uintptr_t bss_cached_bytes =
+            (uintptr_t)&_ebss_cached - (uintptr_t)&_sbss_cached;
+    if (bss_cached_bytes > 0) {
+        memset((void*)&_sbss_cached, 0, bss_cached_bytes);
+        cpu_dcache_clean_range((uintptr_t)&_sbss_cached, bss_cached_bytes);
+    }
+
+    //  Allocate the per-CPU variables, and the TLS blocks of all CPUs.
+    //  Initialize the TLS block of the boot CPU (constructors may use
+    //  thread-local variables).
+    if (percpu_init() != 0) exit(EXIT_FAILURE);
+    if (tls_init() != 0) exit(EXIT_FAILURE);
+    tls_enter(0);
+
     //  Call constructors
     __libc_init_array();
 
@@ -117,13 +138,14 @@ static void bsp_primary_start()
     //  Synchronize pending writes
     cpu_dfence();
 
-    //  Save the per-cpu description into the thread pointer
-    cpu_set_thread_pointer((uintptr_t)&cpu_list[0]);
+    //  Save the per-cpu description into the scratch register
+    cpu_set_scratch((uintptr_t)&cpu_list[0]);
 
     //  Initialize the thread information
     this_cpu->thread         = (thread_t*)malloc(sizeof(thread_t));
     if (this_cpu->thread == NULL) exit(EXIT_FAILURE);
 
+    thread_init(this_cpu->thread);
     this_cpu->thread->id     = 0;
     this_cpu->thread->cpu_id = (void*)((uintptr_t)hid);
     this_cpu->thread->desc   = (cpu_t*)&cpu_list[0];
@@ -166,22 +188,45 @@ static void bsp_secondary_start()
         while(1);
     }
 
+    //  A NULL or WAKEUP IPI kind corresponds to a late wake-up IPI (see
+    //  mp_wakeup_cpu) sent to the previous thread executed by this CPU.
+    //  Ignore it.
+    enum cpu_ipi_e ipi_kind = cpu_get_ipi_kind(sid);
+    if ((ipi_kind == CPU_IPI_NULL) || (ipi_kind == CPU_IPI_WAKEUP)) {
+        int kind = CPU_IPI_WAKEUP;
+        atomic_compare_exchange_strong((atomic_int*)&cpu_list[sid].ipi_kind,
+                &kind, CPU_IPI_NULL);
+        return;
+    }
+
     //  Check the kind of inter-processor interrupt
-    if (cpu_get_ipi_kind(sid) != CPU_IPI_CREATE) {
+    if (ipi_kind != CPU_IPI_CREATE) {
         //  Unexpected IPI
         cpu_set_state(sid, CPU_ERROR);
         while(1);
     }
 
-    //  Save the per-cpu description into the thread pointer
-    cpu_set_thread_pointer((uintptr_t)&cpu_list[sid]);
+    //  Save the per-cpu description into the scratch register, and
+    //  initialize the TLS block and the user-level thread scheduler of the
+    //  new thread
+    cpu_set_scratch((uintptr_t)&cpu_list[sid]);
+    tls_enter(sid);
+    uthread_sched_reset();
 
     //  Signal the director thread that this thread is now awake
     cpu_dfence();
     cpu_set_state(sid, CPU_AWAKE);
 
-    //  Wait for the director thread to declare this thread as running
-    while (cpu_get_state(sid) != CPU_RUNNING) cpu_delay(1000);
+    //  Wait for the director thread to declare this thread as running. If
+    //  the director withdraws the creation request (failed creation of a
+    //  group of threads), go back to IDLE.
+    while (cpu_get_state(sid) != CPU_RUNNING) {
+        if (cpu_get_ipi_kind(sid) != CPU_IPI_CREATE) {
+            cpu_set_state(sid, CPU_IDLE);
+            return;
+        }
+        cpu_delay(1000);
+    }
 
     //  Initialize performance counters
     cpu_set_cycles(0);
@@ -189,18 +234,26 @@ static void bsp_secondary_start()
     cpu_set_imiss(0);
     cpu_set_dmiss(0);
 
+    //  Consume the creation IPI kind. This allows to discriminate wake-up
+    //  IPIs (received while the thread runs or late ones) from creation
+    //  requests.
+    cpu_set_ipi_kind(sid, CPU_IPI_NULL);
+
     //  Call the entry function
+    thread_t *thread = cpu_list[sid].thread;
     cpu_entry_func_t entry_func = cpu_get_entry_func(sid);
     int status = entry_func(cpu_get_args(sid));
 
-    //  Thread finished
+    //  Thread finished: release the CPU, then signal the completion to the
+    //  joiner. This way, the CPU is idle when thread_join returns.
     if (status == THREAD_FAILURE) {
         cpu_dfence();
         cpu_set_state(sid, CPU_ERROR);
+        thread_signal_exit(thread, status);
         while (1);
     }
-    cpu_dfence();
-    cpu_set_state(sid, CPU_IDLE);
+    mp_release_cpu(sid);
+    thread_signal_exit(thread, status);
 }
 
 //
@@ -236,6 +289,20 @@ void bsp_start(int hartid)
     );
 #endif
 
+#ifdef __riscv_vector
+    // Enable the vector unit (RVV extension)
+    asm volatile (
+        "li t0, %[clear_vs] \n"
+        "csrc mstatus, t0   \n"
+        "li t0, %[set_vs]   \n"
+        "csrs mstatus, t0   \n"
+        : /* no outputs */
+        : [clear_vs] "i"(MSTATUS_VS),
+          [set_vs]   "i"(MSTATUS_VS_CLEAN)
+        : "t0", "memory"
+    );
+#endif
+
     if (hartid == BSP_CONFIG_HARTID_BOOT) {
         bsp_primary_start();
         return;
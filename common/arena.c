@@ -0,0 +1,200 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/arena.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines used to allocate memory from
+ *          per-CPU arenas
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "bsp/bsp_config.h"
+#include "common/arena.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/cpu_defs.h"
+#include "common/mp.h"
+#include "common/percpu.h"
+
+#if ARENA_CHUNK_SIZE < (ARENA_MAX_SIZE + 16)
+#error "ARENA_CHUNK_SIZE shall hold at least one block of the biggest class"
+#endif
+
+#define ARENA_CLASS_LARGE (-1)
+
+typedef struct arena_hdr_s
+{
+    /* Logical CPU owning the block */
+    int owner;
+
+    /* Size class, or ARENA_CLASS_LARGE when allocated by malloc */
+    int cls;
+} __attribute__((aligned(16))) arena_hdr_t;
+
+typedef struct arena_s
+{
+    /* Free blocks of each size class (linked through their payload) */
+    void *free[ARENA_NCLASSES];
+
+    /* Unused part of the last chunk */
+    char *bump;
+    char *bump_end;
+} arena_t;
+
+typedef struct arena_remote_s
+{
+    /* Blocks freed by other CPUs (linked through their payload) */
+    atomic_uintptr_t head;
+} __cl_aligned__ arena_remote_t;
+
+static DEFINE_PER_CPU(arena_t, __arena);
+static arena_remote_t __arena_remote[BSP_CONFIG_NCPUS];
+
+//
+//  The local arena is accessed with interrupts masked, so that a preempting
+//  user-level thread of the same CPU does not interleave its updates
+//
+static inline uintptr_t __arena_irq_save()
+{
+    uintptr_t mstatus = read_csr(mstatus);
+    cpu_disable_interrupts();
+    return mstatus & MSTATUS_MIE;
+}
+
+static inline void __arena_irq_restore(uintptr_t mie)
+{
+    if (mie) cpu_enable_interrupts();
+}
+
+static inline arena_hdr_t* __arena_hdr(void *p)
+{
+    return (arena_hdr_t*)p - 1;
+}
+
+static inline int __arena_class(size_t size)
+{
+    int cls = 0;
+    while (((size_t)ARENA_MIN_SIZE << cls) < size) cls++;
+    return cls;
+}
+
+//
+//  Moves the blocks freed by other CPUs to the local free lists. The remote
+//  list is detached at once, so there is no ABA problem.
+//
+static void __arena_drain(arena_t *a, int sid)
+{
+    uintptr_t next = atomic_exchange(&__arena_remote[sid].head, 0);
+    while (next != 0) {
+        void *p = (void*)next;
+
+        //  If there is no hardware cache coherency, make sure that the link
+        //  (written by the freeing CPU) is not cached
+        cpu_dcache_invalidate_range((uintptr_t)p, sizeof(void*));
+
+        next = *(uintptr_t*)p;
+        int cls = __arena_hdr(p)->cls;
+        *(void**)p = a->free[cls];
+        a->free[cls] = p;
+    }
+}
+
+static void *__arena_carve(arena_t *a, int cls)
+{
+    size_t bytes = sizeof(arena_hdr_t) + ((size_t)ARENA_MIN_SIZE << cls);
+
+    if ((size_t)(a->bump_end - a->bump) < bytes) {
+        //  The tail of the previous chunk is lost
+        char *chunk = (char*)malloc(ARENA_CHUNK_SIZE);
+        if (chunk == NULL) return NULL;
+        a->bump     = chunk;
+        a->bump_end = chunk + ARENA_CHUNK_SIZE;
+    }
+
+    arena_hdr_t *hdr = (arena_hdr_t*)a->bump;
+    a->bump += bytes;
+    return hdr + 1;
+}
+
+void *arena_alloc(size_t size)
+{
+    int sid = mp_get_self_sid();
+    arena_hdr_t *hdr;
+    void *p;
+
+    if (size > ARENA_MAX_SIZE) {
+        hdr = (arena_hdr_t*)malloc(sizeof(arena_hdr_t) + size);
+        if (hdr == NULL) return NULL;
+        hdr->owner = sid;
+        hdr->cls   = ARENA_CLASS_LARGE;
+        return hdr + 1;
+    }
+
+    int cls = __arena_class(size);
+    uintptr_t mie = __arena_irq_save();
+    arena_t *a = this_cpu_ptr(__arena);
+
+    if (a->free[cls] == NULL) __arena_drain(a, sid);
+    if (a->free[cls] != NULL) {
+        p = a->free[cls];
+        a->free[cls] = *(void**)p;
+    } else {
+        p = __arena_carve(a, cls);
+    }
+    __arena_irq_restore(mie);
+    if (p == NULL) return NULL;
+
+    hdr = __arena_hdr(p);
+    hdr->owner = sid;
+    hdr->cls   = cls;
+    return p;
+}
+
+void arena_free(void *p)
+{
+    if (p == NULL) return;
+
+    //  If there is no hardware cache coherency, make sure that the header
+    //  (written by the allocating CPU) is not cached
+    arena_hdr_t *hdr = __arena_hdr(p);
+    cpu_dcache_invalidate_range((uintptr_t)hdr, sizeof(*hdr));
+
+    if (hdr->cls == ARENA_CLASS_LARGE) {
+        free(hdr);
+        return;
+    }
+
+    int sid = mp_get_self_sid();
+    if (hdr->owner == sid) {
+        uintptr_t mie = __arena_irq_save();
+        arena_t *a = this_cpu_ptr(__arena);
+        *(void**)p = a->free[hdr->cls];
+        a->free[hdr->cls] = p;
+        __arena_irq_restore(mie);
+        return;
+    }
+
+    //  Push the block to the remote free list of the owner. Make sure that
+    //  the link is visible before publishing the block.
+    arena_remote_t *r = &__arena_remote[hdr->owner];
+    uintptr_t head = atomic_load_uncached(&r->head);
+    do {
+        *(uintptr_t*)p = head;
+        cpu_dfence();
+    } while (!atomic_compare_exchange_weak(&r->head, &head, (uintptr_t)p));
+}
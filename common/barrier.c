@@ -0,0 +1,221 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/barrier.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to
+ *          synchronize multiple CPUs with barriers
+ */
+#include "common/barrier.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/mp.h"
+#include "common/thread_pool.h"
+
+#define BARRIER_POLL_DELAY 50
+
+//
+//  Episode numbers are monotonic. Compare them with wrap-around.
+//
+static inline int __barrier_reached(atomic_int *flag, int episode)
+{
+    return ((int)((unsigned)atomic_load_uncached(flag) - (unsigned)episode) >= 0);
+}
+
+static inline void __barrier_pause(barrier_t *b)
+{
+    if (b->flags & BARRIER_WFI) mp_wait_for_wakeup();
+    else                        cpu_delay(BARRIER_POLL_DELAY);
+}
+
+static inline void __barrier_wakeup(barrier_t *b, int rank)
+{
+    if (b->flags & BARRIER_WFI) mp_wakeup_cpu(rank);
+}
+
+static void __barrier_wait_centralized(barrier_t *b, int rank)
+{
+    barrier_cpu_t *c = &b->cpu[rank];
+    int sense = !atomic_load_uncached(&c->local);
+    atomic_store_uncached(&c->local, sense);
+
+    cpu_dfence();
+    if (atomic_fetch_sub(&b->count, 1) == 1) {
+        //  Last arrival: reset the counter and release the other CPUs
+        atomic_store_uncached(&b->count, b->ncpus);
+        atomic_store_uncached(&b->sense, sense);
+        for (int i = 0; i < b->ncpus; i++) {
+            if (i != rank) __barrier_wakeup(b, i);
+        }
+        return;
+    }
+
+    while (atomic_load_uncached(&b->sense) != sense) __barrier_pause(b);
+}
+
+static void __barrier_wait_tree(barrier_t *b, int rank)
+{
+    barrier_cpu_t *c = &b->cpu[rank];
+    int episode = atomic_load_uncached(&c->local) + 1;
+    atomic_store_uncached(&c->local, episode);
+
+    //  Arrival phase: wait for the subtrees of children
+    for (int child = 2*rank + 1; child <= 2*rank + 2; child++) {
+        if (child >= b->ncpus) break;
+        while (!__barrier_reached(&b->cpu[child].arrive, episode)) {
+            __barrier_pause(b);
+        }
+    }
+
+    cpu_dfence();
+    if (rank != 0) {
+        //  Signal the arrival of this subtree and wait for the parent
+        int parent = (rank - 1) / 2;
+        atomic_store_uncached(&c->arrive, episode);
+        __barrier_wakeup(b, parent);
+        while (!__barrier_reached(&b->cpu[parent].release, episode)) {
+            __barrier_pause(b);
+        }
+    }
+
+    //  Release phase: release the children
+    atomic_store_uncached(&c->release, episode);
+    for (int child = 2*rank + 1; child <= 2*rank + 2; child++) {
+        if (child >= b->ncpus) break;
+        __barrier_wakeup(b, child);
+    }
+}
+
+static void __barrier_wait_dissemination(barrier_t *b, int rank)
+{
+    barrier_cpu_t *c = &b->cpu[rank];
+    int episode = atomic_load_uncached(&c->local) + 1;
+    atomic_store_uncached(&c->local, episode);
+
+    cpu_dfence();
+    for (int k = 0, dist = 1; dist < b->ncpus; k++, dist <<= 1) {
+        int partner = (rank + dist) % b->ncpus;
+        atomic_store_uncached(&b->cpu[partner].round[k], episode);
+        __barrier_wakeup(b, partner);
+        while (!__barrier_reached(&c->round[k], episode)) {
+            __barrier_pause(b);
+        }
+    }
+}
+
+int barrier_init(barrier_t *b, enum barrier_kind_e kind, int ncpus, int flags)
+{
+    if ((ncpus <= 0) || (ncpus > BSP_CONFIG_NCPUS)) return -1;
+
+    b->kind  = kind;
+    b->ncpus = ncpus;
+    b->flags = flags;
+    atomic_store_uncached(&b->count, ncpus);
+    atomic_store_uncached(&b->sense, 0);
+
+    for (int i = 0; i < ncpus; i++) {
+        barrier_cpu_t *c = &b->cpu[i];
+        atomic_store_uncached(&c->local, 0);
+        atomic_store_uncached(&c->arrive, 0);
+        atomic_store_uncached(&c->release, 0);
+        for (int k = 0; k < BARRIER_MAX_ROUNDS; k++) {
+            atomic_store_uncached(&c->round[k], 0);
+        }
+    }
+
+    //  Make sure that the barrier is visible
+    cpu_dfence();
+    return 0;
+}
+
+void barrier_destroy(barrier_t *b)
+{
+}
+
+void barrier_wait(barrier_t *b)
+{
+    int rank = mp_get_self_sid();
+    if ((b->ncpus <= 1) || (rank >= b->ncpus)) return;
+
+    switch (b->kind) {
+        case BARRIER_CENTRALIZED:
+            __barrier_wait_centralized(b, rank);
+            break;
+        case BARRIER_TREE:
+            __barrier_wait_tree(b, rank);
+            break;
+        case BARRIER_DISSEMINATION:
+            __barrier_wait_dissemination(b, rank);
+            break;
+    }
+}
+
+//
+//  Latency measurement
+//
+typedef struct barrier_bench_s
+{
+    barrier_t barrier;
+    int niters;
+} barrier_bench_t;
+
+static barrier_bench_t __barrier_bench;
+static thread_pool_t __barrier_bench_pool __cl_aligned__;
+
+static int __barrier_bench_worker(void *args)
+{
+    barrier_bench_t *bench = (barrier_bench_t*)args;
+    for (int i = 0; i < bench->niters; i++) barrier_wait(&bench->barrier);
+    return THREAD_SUCCESS;
+}
+
+uint64_t barrier_measure_latency(enum barrier_kind_e kind, int flags,
+        int ncpus, int niters)
+{
+    thread_pool_t *pool = &__barrier_bench_pool;
+    barrier_bench_t *bench = &__barrier_bench;
+    int pool_flags = (flags & BARRIER_WFI) ? THREAD_POOL_WFI : 0;
+
+    if ((niters <= 0) || (mp_get_self_sid() != 0)) return 0;
+    if (barrier_init(&bench->barrier, kind, ncpus, flags) != 0) return 0;
+    if (thread_pool_init(pool, ncpus - 1, pool_flags) != 0) return 0;
+
+    //  The calling CPU is the rank 0 of the barrier. Workers shall be placed
+    //  in CPUs 1 to ncpus-1
+    for (int i = 0; i < thread_pool_size(pool); i++) {
+        if (pool->worker[i].cpu_id >= ncpus) {
+            thread_pool_destroy(pool);
+            return 0;
+        }
+    }
+
+    bench->niters = niters;
+    cpu_dfence();
+    thread_pool_submit_all(pool, __barrier_bench_worker, bench);
+
+    //  Warm-up episode
+    barrier_wait(&bench->barrier);
+
+    uint64_t start = cpu_cycles();
+    for (int i = 1; i < niters; i++) barrier_wait(&bench->barrier);
+    uint64_t end = cpu_cycles();
+
+    thread_pool_wait_all(pool);
+    thread_pool_destroy(pool);
+
+    return (niters > 1) ? (end - start) / (niters - 1) : 0;
+}
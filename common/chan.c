@@ -0,0 +1,207 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/chan.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to exchange
+ *          messages between CPUs through channels
+ */
+#include <string.h>
+#include "common/backoff.h"
+#include "common/cache.h"
+#include "common/chan.h"
+#include "common/cpu.h"
+
+#ifndef CHAN_BACKOFF_MIN
+#define CHAN_BACKOFF_MIN 16
+#endif
+#ifndef CHAN_BACKOFF_MAX
+#define CHAN_BACKOFF_MAX 1024
+#endif
+
+int chan_init(chan_t *c, chan_slot_t *slot, size_t nslots, size_t msg_bytes,
+        int flags)
+{
+    if ((nslots == 0) || ((nslots & (nslots - 1)) != 0)) return -1;
+    if ((msg_bytes == 0) || (msg_bytes > CHAN_MSG_MAX_BYTES)) return -1;
+
+    c->slot      = slot;
+    c->mask      = nslots - 1;
+    c->msg_bytes = msg_bytes;
+    c->flags     = flags;
+    for (size_t i = 0; i < nslots; i++) {
+        atomic_store_uncached(&slot[i].seq, i);
+    }
+    atomic_store_uncached(&c->head, 0);
+    atomic_store_uncached(&c->tail, 0);
+    waitq_init(&c->recvq);
+    waitq_init(&c->sendq);
+
+    //  Make sure that the channel is visible
+    cpu_dfence();
+    return 0;
+}
+
+void chan_destroy(chan_t *c)
+{
+    waitq_destroy(&c->recvq);
+    waitq_destroy(&c->sendq);
+}
+
+static int __chan_try_send(chan_t *c, const void *msg, size_t bytes)
+{
+    unsigned long pos = atomic_load_uncached(&c->head);
+    chan_slot_t *s;
+
+    for (;;) {
+        s = &c->slot[pos & c->mask];
+        long diff = (long)(atomic_load_uncached(&s->seq) - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak(&c->head, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = atomic_load_uncached(&c->head);
+        }
+    }
+
+    //  If the slot is cached, write the message back to the memory before
+    //  publishing it
+    memcpy(s->msg, msg, bytes);
+    cpu_dcache_clean_range((uintptr_t)s->msg, bytes);
+    cpu_dfence();
+    atomic_store_uncached(&s->seq, pos + 1);
+
+    if (c->flags & CHAN_NOTIFY) waitq_wake_one(&c->recvq);
+    return 0;
+}
+
+static int __chan_try_recv(chan_t *c, void *msg, size_t bytes)
+{
+    unsigned long pos = atomic_load_uncached(&c->tail);
+    chan_slot_t *s;
+
+    for (;;) {
+        s = &c->slot[pos & c->mask];
+        long diff = (long)(atomic_load_uncached(&s->seq) - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak(&c->tail, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = atomic_load_uncached(&c->tail);
+        }
+    }
+
+    //  If the slot is cached, make sure that the message is read from memory
+    cpu_dcache_invalidate_range((uintptr_t)s->msg, bytes);
+    memcpy(msg, s->msg, bytes);
+    cpu_dfence();
+    atomic_store_uncached(&s->seq, pos + c->mask + 1);
+
+    if (c->flags & CHAN_NOTIFY) waitq_wake_one(&c->sendq);
+    return 0;
+}
+
+//
+//  Blocking operations: busy-wait with exponential backoff or, when
+//  notifications are enabled, sleep until the other side wakes us up
+//
+static void __chan_send(chan_t *c, const void *msg, size_t bytes)
+{
+    backoff_t b;
+    backoff_init(&b, CHAN_BACKOFF_MIN, CHAN_BACKOFF_MAX);
+
+    while (__chan_try_send(c, msg, bytes) != 0) {
+        if (!(c->flags & CHAN_NOTIFY)) {
+            backoff_exponential(&b);
+            continue;
+        }
+
+        waitq_prepare(&c->sendq);
+        if (__chan_try_send(c, msg, bytes) == 0) {
+            waitq_cancel(&c->sendq);
+            return;
+        }
+        waitq_wait(&c->sendq);
+    }
+}
+
+static void __chan_recv(chan_t *c, void *msg, size_t bytes)
+{
+    backoff_t b;
+    backoff_init(&b, CHAN_BACKOFF_MIN, CHAN_BACKOFF_MAX);
+
+    while (__chan_try_recv(c, msg, bytes) != 0) {
+        if (!(c->flags & CHAN_NOTIFY)) {
+            backoff_exponential(&b);
+            continue;
+        }
+
+        waitq_prepare(&c->recvq);
+        if (__chan_try_recv(c, msg, bytes) == 0) {
+            waitq_cancel(&c->recvq);
+            return;
+        }
+        waitq_wait(&c->recvq);
+    }
+}
+
+int chan_try_send(chan_t *c, const void *msg)
+{
+    return __chan_try_send(c, msg, c->msg_bytes);
+}
+
+void chan_send(chan_t *c, const void *msg)
+{
+    __chan_send(c, msg, c->msg_bytes);
+}
+
+int chan_try_recv(chan_t *c, void *msg)
+{
+    return __chan_try_recv(c, msg, c->msg_bytes);
+}
+
+void chan_recv(chan_t *c, void *msg)
+{
+    __chan_recv(c, msg, c->msg_bytes);
+}
+
+int chan_send_buf(chan_t *c, void *buf, size_t bytes)
+{
+    chan_buf_t m = { .buf = buf, .bytes = bytes };
+    if (c->msg_bytes < sizeof(chan_buf_t)) return -1;
+
+    //  Write the buffer back to the memory before handing it over
+    cpu_dcache_clean_range((uintptr_t)buf, bytes);
+    __chan_send(c, &m, sizeof(m));
+    return 0;
+}
+
+int chan_recv_buf(chan_t *c, void **buf, size_t *bytes)
+{
+    chan_buf_t m;
+    if (c->msg_bytes < sizeof(chan_buf_t)) return -1;
+
+    __chan_recv(c, &m, sizeof(m));
+
+    //  The previous owner may have modified the buffer
+    cpu_dcache_invalidate_range((uintptr_t)m.buf, m.bytes);
+    *buf   = m.buf;
+    *bytes = m.bytes;
+    return 0;
+}
@@ -0,0 +1,221 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/collective.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the collective operations (broadcast,
+ *          reduction and prefix scan) across multiple CPUs
+ */
+#include "common/collective.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/mp.h"
+
+#define COLL_POLL_DELAY 50
+
+//
+//  Episode numbers are monotonic. Compare them with wrap-around.
+//
+static inline int __coll_reached(atomic_int *flag, int episode)
+{
+    return ((int)((unsigned)atomic_load_uncached(flag) - (unsigned)episode) >= 0);
+}
+
+static inline void __coll_wait(coll_t *c, atomic_int *flag, int episode)
+{
+    while (!__coll_reached(flag, episode)) {
+        if (c->flags & COLL_WFI) mp_wait_for_wakeup();
+        else                     cpu_delay(COLL_POLL_DELAY);
+    }
+}
+
+static inline void __coll_wakeup(coll_t *c, int rank)
+{
+    if (c->flags & COLL_WFI) mp_wakeup_cpu(rank);
+}
+
+static inline void __coll_put(atomic_ullong *p, coll_value_t v)
+{
+    atomic_store_uncached(p, (unsigned long long)v.u64);
+}
+
+static inline coll_value_t __coll_get(atomic_ullong *p)
+{
+    coll_value_t v = { .u64 = atomic_load_uncached(p) };
+    return v;
+}
+
+//
+//  Binomial tree rooted at the given CPU. In relative IDs (rank - root), the
+//  parent of a node is obtained by clearing its lowest set bit.
+//
+//  Up-sweep: each node combines the values of its children and sends the
+//  result to its parent (no combination when op is NULL).
+//  Down-sweep: the value of the root is propagated to all nodes. It also
+//  guarantees that all slots were read before they are reused.
+//
+static coll_value_t __coll_tree(coll_t *c, int root, coll_value_t v,
+        coll_op_t op)
+{
+    int rank = mp_get_self_sid();
+    int n = c->ncpus;
+    if ((n <= 1) || (rank >= n)) return v;
+
+    coll_slot_t *s = &c->slot[rank];
+    int episode = atomic_load_uncached(&s->local) + 1;
+    atomic_store_uncached(&s->local, episode);
+
+    int rel = (rank - root + n) % n;
+    int mask;
+
+    //  Up-sweep
+    for (mask = 1; mask < n; mask <<= 1) {
+        if (rel & mask) {
+            __coll_put(&s->value, v);
+            atomic_store_uncached(&s->up, episode);
+            __coll_wakeup(c, (rel - mask + root) % n);
+            break;
+        }
+
+        int child = rel | mask;
+        if (child < n) {
+            coll_slot_t *cs = &c->slot[(child + root) % n];
+            __coll_wait(c, &cs->up, episode);
+            if (op != NULL) v = op(v, __coll_get(&cs->value));
+        }
+    }
+
+    //  Down-sweep
+    if (rel != 0) {
+        coll_slot_t *ps = &c->slot[((rel & (rel - 1)) + root) % n];
+        __coll_wait(c, &ps->down, episode);
+        v = __coll_get(&ps->value);
+    }
+    __coll_put(&s->value, v);
+    atomic_store_uncached(&s->down, episode);
+
+    //  Children are the nodes rel | m, with m lower than the lowest set bit
+    for (int m = 1; m < mask; m <<= 1) {
+        if ((rel | m) < n) __coll_wakeup(c, ((rel | m) + root) % n);
+    }
+    return v;
+}
+
+int coll_init(coll_t *c, int ncpus, int flags)
+{
+    if ((ncpus <= 0) || (ncpus > BSP_CONFIG_NCPUS)) return -1;
+    if (barrier_init(&c->barrier, BARRIER_TREE, ncpus, flags) != 0) return -1;
+
+    c->ncpus = ncpus;
+    c->flags = flags;
+    for (int i = 0; i < ncpus; i++) {
+        coll_slot_t *s = &c->slot[i];
+        atomic_store_uncached(&s->local, 0);
+        atomic_store_uncached(&s->up, 0);
+        atomic_store_uncached(&s->down, 0);
+        atomic_store_uncached(&s->value, 0);
+        for (int k = 0; k < BARRIER_MAX_ROUNDS; k++) {
+            atomic_store_uncached(&s->scan_value[k], 0);
+            atomic_store_uncached(&s->scan_episode[k], 0);
+        }
+    }
+
+    //  Make sure that the collective is visible
+    cpu_dfence();
+    return 0;
+}
+
+void coll_destroy(coll_t *c)
+{
+    barrier_destroy(&c->barrier);
+}
+
+coll_value_t coll_bcast(coll_t *c, int root, coll_value_t v)
+{
+    return __coll_tree(c, root, v, NULL);
+}
+
+coll_value_t coll_reduce(coll_t *c, int root, coll_value_t v, coll_op_t op)
+{
+    return __coll_tree(c, root, v, op);
+}
+
+coll_value_t coll_allreduce(coll_t *c, coll_value_t v, coll_op_t op)
+{
+    return __coll_tree(c, 0, v, op);
+}
+
+coll_value_t coll_scan(coll_t *c, coll_value_t v, coll_op_t op)
+{
+    int rank = mp_get_self_sid();
+    int n = c->ncpus;
+    if ((n <= 1) || (rank >= n)) return v;
+
+    coll_slot_t *s = &c->slot[rank];
+    int episode = atomic_load_uncached(&s->local) + 1;
+    atomic_store_uncached(&s->local, episode);
+
+    //  At step k, CPU i combines its partial result with that of CPU i-2^k
+    for (int k = 0, dist = 1; dist < n; k++, dist <<= 1) {
+        __coll_put(&s->scan_value[k], v);
+        atomic_store_uncached(&s->scan_episode[k], episode);
+        if (rank + dist < n) __coll_wakeup(c, rank + dist);
+
+        if (rank >= dist) {
+            coll_slot_t *ls = &c->slot[rank - dist];
+            __coll_wait(c, &ls->scan_episode[k], episode);
+            v = op(__coll_get(&ls->scan_value[k]), v);
+        }
+    }
+
+    //  Make sure that all partial results were read before reusing the slots
+    barrier_wait(&c->barrier);
+    return v;
+}
+
+//
+//  Predefined combiners
+//
+coll_value_t coll_op_sum_i64(coll_value_t a, coll_value_t b)
+{
+    return coll_i64(a.i64 + b.i64);
+}
+
+coll_value_t coll_op_min_i64(coll_value_t a, coll_value_t b)
+{
+    return (a.i64 < b.i64) ? a : b;
+}
+
+coll_value_t coll_op_max_i64(coll_value_t a, coll_value_t b)
+{
+    return (a.i64 > b.i64) ? a : b;
+}
+
+coll_value_t coll_op_sum_f64(coll_value_t a, coll_value_t b)
+{
+    return coll_f64(a.f64 + b.f64);
+}
+
+coll_value_t coll_op_min_f64(coll_value_t a, coll_value_t b)
+{
+    return (a.f64 < b.f64) ? a : b;
+}
+
+coll_value_t coll_op_max_f64(coll_value_t a, coll_value_t b)
+{
+    return (a.f64 > b.f64) ? a : b;
+}
@@ -0,0 +1,53 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/condvar.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          condition variables
+ */
+#include "common/condvar.h"
+
+void condvar_init(condvar_t *c)
+{
+    waitq_init(&c->waitq);
+}
+
+void condvar_destroy(condvar_t *c)
+{
+    waitq_destroy(&c->waitq);
+}
+
+void condvar_wait(condvar_t *c, sleep_mutex_t *m)
+{
+    //  Register as waiter before releasing the mutex. Thus, a signal sent
+    //  after the release is not lost.
+    waitq_prepare(&c->waitq);
+    sleep_mutex_unlock(m);
+    waitq_wait(&c->waitq);
+    sleep_mutex_lock(m);
+}
+
+void condvar_signal(condvar_t *c)
+{
+    waitq_wake_one(&c->waitq);
+}
+
+void condvar_broadcast(condvar_t *c)
+{
+    waitq_wake_all(&c->waitq);
+}
@@ -0,0 +1,123 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/mcs_mutex.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          MCS queue mutexes (mutual exclusion locks)
+ */
+#include "common/mcs_mutex.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/cpu_defs.h"
+#include "common/mp.h"
+
+#define MUTEX_WAIT_DELAY 100
+
+//
+//  Interrupts are masked while the mutex is held (see mcs_mutex.h)
+//
+static inline int __mcs_mutex_irq_save()
+{
+    int mie = (read_csr(mstatus) & MSTATUS_MIE) != 0;
+    cpu_disable_interrupts();
+    return mie;
+}
+
+static inline void __mcs_mutex_irq_restore(int mie)
+{
+    if (mie) cpu_enable_interrupts();
+}
+
+void mcs_mutex_init(mcs_mutex_t *m)
+{
+    atomic_store_uncached(&m->tail, 0);
+    for (int i = 0; i < BSP_CONFIG_NCPUS; i++) {
+        atomic_store_uncached(&m->node[i].next, 0);
+        atomic_store_uncached(&m->node[i].locked, 0);
+        m->node[i].mie = 0;
+    }
+}
+
+void mcs_mutex_destroy(mcs_mutex_t *m)
+{
+}
+
+void mcs_mutex_lock(mcs_mutex_t *m)
+{
+    int mie = __mcs_mutex_irq_save();
+    int me = mp_get_self_sid() + 1;
+    mcs_mutex_node_t *node = &m->node[me - 1];
+
+    node->mie = mie;
+    atomic_store_uncached(&node->next, 0);
+    atomic_store_uncached(&node->locked, 1);
+
+    cpu_dfence();
+    int prev = atomic_exchange(&m->tail, me);
+    if (prev == 0) return;
+
+    //  Enqueue behind the previous waiter and poll the own node
+    atomic_store_uncached(&m->node[prev - 1].next, me);
+    while (atomic_load_uncached(&node->locked)) {
+        cpu_delay(MUTEX_WAIT_DELAY);
+    }
+}
+
+int mcs_mutex_trylock(mcs_mutex_t *m)
+{
+    int mie = __mcs_mutex_irq_save();
+    int me = mp_get_self_sid() + 1;
+    int expected = 0;
+
+    atomic_store_uncached(&m->node[me - 1].next, 0);
+    cpu_dfence();
+    if (!atomic_compare_exchange_strong(&m->tail, &expected, me)) {
+        __mcs_mutex_irq_restore(mie);
+        return 0;
+    }
+
+    m->node[me - 1].mie = mie;
+    return 1;
+}
+
+void mcs_mutex_unlock(mcs_mutex_t *m)
+{
+    int me = mp_get_self_sid() + 1;
+    mcs_mutex_node_t *node = &m->node[me - 1];
+    int mie = node->mie;
+
+    cpu_dfence();
+    int next = atomic_load_uncached(&node->next);
+    if (next == 0) {
+        //  No known successor: try to release the mutex
+        int expected = me;
+        if (atomic_compare_exchange_strong(&m->tail, &expected, 0)) {
+            __mcs_mutex_irq_restore(mie);
+            return;
+        }
+
+        //  A successor is enqueuing: wait for it to link its node
+        while ((next = atomic_load_uncached(&node->next)) == 0) {
+            cpu_nop();
+        }
+    }
+
+    //  Hand the mutex over to the successor
+    atomic_store_uncached(&m->node[next - 1].locked, 0);
+    __mcs_mutex_irq_restore(mie);
+}
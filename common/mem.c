@@ -21,8 +21,18 @@
  */
 #include <stdint.h>
 #include <string.h>
+#include "common/cache.h"
+#include "common/compiler.h"
+#include "common/mem.h"
 
-static inline void* __memset_byte(
+//
+//  Minimum size of a memset to zero using cache-block zero operations
+//
+#ifndef MEM_ZERO_LINES_MIN
+#define MEM_ZERO_LINES_MIN      (4*BSP_CONFIG_DCACHE_LINE_BYTES)
+#endif
+
+static inline __NO_LIBCALL__ void* __memset_byte(
         unsigned char *s,
         unsigned char c,
         size_t nbytes)
@@ -33,16 +43,13 @@ static inline void* __memset_byte(
     return (void*)s;
 }
 
-static inline void* __memset_word(
+static inline __NO_LIBCALL__ void* __memset_word(
         unsigned long *s,
         unsigned char c,
         size_t nwords)
 {
-    unsigned long word = (c << 24) | (c << 16) | (c << 8) | c;
-
-#if __SIZEOF_LONG__ == 8
-    word = (word << 32) | word;
-#endif
+    //  Replicate the byte in all the bytes of the word
+    unsigned long word = (unsigned long)c * (~0UL / 0xff);
 
     for (; nwords > 0; nwords--)
         *s++ = word;
@@ -50,7 +57,7 @@ static inline void* __memset_word(
     return (void*)s;
 }
 
-void *memset(void *s, int c, size_t n)
+static void* __memset(void *s, int c, size_t n)
 {
     const void *_s = s;
     const size_t wsize = sizeof(long);
@@ -74,38 +81,236 @@ void *memset(void *s, int c, size_t n)
     return (void*)_s;
 }
 
-void *memcpy(void *dest, const void *src, size_t n)
+void *memset(void *s, int c, size_t n)
+{
+#if BSP_CONFIG_DCACHE_ZERO_LINE_IS_SUPPORTED
+    //  Large zeroing: the line-aligned interior of the buffer is zeroed with
+    //  cache-block zero operations, the head and the tail with stores
+    if (((unsigned char)c == 0) && (n >= MEM_ZERO_LINES_MIN)) {
+        unsigned char *p = (unsigned char*)s;
+        size_t head = (BSP_CONFIG_DCACHE_LINE_BYTES -
+                ((uintptr_t)p % BSP_CONFIG_DCACHE_LINE_BYTES)) %
+                BSP_CONFIG_DCACHE_LINE_BYTES;
+        size_t nlines = (n - head) / BSP_CONFIG_DCACHE_LINE_BYTES;
+        size_t body = nlines*BSP_CONFIG_DCACHE_LINE_BYTES;
+
+        __memset(p, 0, head);
+        mem_zero_lines(p + head, nlines);
+        __memset(p + head + body, 0, n - head - body);
+        return s;
+    }
+#endif
+    return __memset(s, c, n);
+}
+
+//
+//  Copy routines
+//
+//  Size classes:
+//  - small: copied byte per byte;
+//  - medium: the destination is aligned (byte head), then words are copied
+//    (shift-and-merge when the source is not aligned with the destination),
+//    and the remaining bytes (byte tail);
+//  - large: as medium, but source lines are prefetched ahead of the copy.
+//
+#ifndef MEM_COPY_SMALL
+#define MEM_COPY_SMALL          (4*sizeof(unsigned long))
+#endif
+#ifndef MEM_COPY_PREFETCH_MIN
+#define MEM_COPY_PREFETCH_MIN   1024
+#endif
+#ifndef MEM_COPY_PREFETCH_DIST
+#define MEM_COPY_PREFETCH_DIST  (4*BSP_CONFIG_DCACHE_LINE_BYTES)
+#endif
+
+#define MEM_WSIZE  sizeof(unsigned long)
+#define MEM_WBITS  (8*MEM_WSIZE)
+
+typedef unsigned long __attribute__((__may_alias__)) mem_word_t;
+
+static inline __ALWAYS_INLINE__ void __mem_prefetch(uintptr_t addr)
+{
+    cpu_dcache_prefetch_address(addr + MEM_COPY_PREFETCH_DIST);
+}
+
+static __NO_LIBCALL__ void __memcpy_byte_fwd(
+        unsigned char *d,
+        const unsigned char *s,
+        size_t n)
+{
+    for (; n > 0; n--)
+        *d++ = *s++;
+}
+
+static __NO_LIBCALL__ void __memcpy_byte_bwd(
+        unsigned char *d,
+        const unsigned char *s,
+        size_t n)
+{
+    for (; n > 0; n--)
+        *--d = *--s;
+}
+
+//
+//  Forward copy of nwords words. The destination is aligned. If shift is not
+//  zero, the source is misaligned by shift bits: s points to the aligned
+//  word containing the first source byte.
+//
+static __NO_LIBCALL__ void __memcpy_word_fwd(
+        mem_word_t *d,
+        const mem_word_t *s,
+        size_t nwords,
+        unsigned shift,
+        int prefetch)
+{
+    if (shift == 0) {
+        for (; nwords >= 8; nwords -= 8) {
+            if (prefetch) __mem_prefetch((uintptr_t)s);
+            mem_word_t w0 = s[0], w1 = s[1], w2 = s[2], w3 = s[3];
+            mem_word_t w4 = s[4], w5 = s[5], w6 = s[6], w7 = s[7];
+            d[0] = w0; d[1] = w1; d[2] = w2; d[3] = w3;
+            d[4] = w4; d[5] = w5; d[6] = w6; d[7] = w7;
+            s += 8;
+            d += 8;
+        }
+        for (; nwords > 0; nwords--)
+            *d++ = *s++;
+        return;
+    }
+
+    //  Each destination word merges the upper part of a source word and the
+    //  lower part of the next one (little-endian). Only source words
+    //  containing bytes to be copied are read.
+    const unsigned rshift = MEM_WBITS - shift;
+    mem_word_t w0 = s[0];
+    for (; nwords >= 4; nwords -= 4) {
+        if (prefetch) __mem_prefetch((uintptr_t)s);
+        mem_word_t w1 = s[1], w2 = s[2], w3 = s[3], w4 = s[4];
+        d[0] = (w0 >> shift) | (w1 << rshift);
+        d[1] = (w1 >> shift) | (w2 << rshift);
+        d[2] = (w2 >> shift) | (w3 << rshift);
+        d[3] = (w3 >> shift) | (w4 << rshift);
+        w0 = w4;
+        s += 4;
+        d += 4;
+    }
+    for (; nwords > 0; nwords--) {
+        mem_word_t w1 = s[1];
+        *d++ = (w0 >> shift) | (w1 << rshift);
+        w0 = w1;
+        s++;
+    }
+}
+
+//
+//  Backward copy of nwords words ending at d and s (excluded). The
+//  destination is aligned. If shift is not zero, the source end is misaligned
+//  by shift bits: s points to the aligned word containing the last source
+//  byte.
+//
+static __NO_LIBCALL__ void __memcpy_word_bwd(
+        mem_word_t *d,
+        const mem_word_t *s,
+        size_t nwords,
+        unsigned shift)
 {
-    size_t _n = n;
-    uintptr_t *_dest = (uintptr_t*)dest;
-    uintptr_t *_src = (uintptr_t*)src;
-
-    uintptr_t s0, s1, s2, s3;
-    if (_n >= (4*sizeof(uintptr_t))) {
-        s0 = _src[0];
-        s1 = _src[1];
-        s2 = _src[2];
-        s3 = _src[3];
-        while (_n >= (4*sizeof(uintptr_t))) {
-            _src += 4;
-            _n -= 4*sizeof(uintptr_t);
-            _dest[0] = s0;
-            s0 = _src[0];
-            _dest[1] = s1;
-            s1 = _src[1];
-            _dest[2] = s2;
-            s2 = _src[2];
-            _dest[3] = s3;
-            s3 = _src[3];
-            _dest += 4;
+    if (shift == 0) {
+        for (; nwords >= 4; nwords -= 4) {
+            mem_word_t w0 = s[-1], w1 = s[-2], w2 = s[-3], w3 = s[-4];
+            d[-1] = w0; d[-2] = w1; d[-3] = w2; d[-4] = w3;
+            s -= 4;
+            d -= 4;
         }
+        for (; nwords > 0; nwords--)
+            *--d = *--s;
+        return;
     }
 
-    while (_n--) {
-        *_dest = *_src;
-        _dest++;
-        _src++;
+    const unsigned rshift = MEM_WBITS - shift;
+    mem_word_t w1 = s[0];
+    for (; nwords > 0; nwords--) {
+        mem_word_t w0 = s[-1];
+        *--d = (w0 >> shift) | (w1 << rshift);
+        w1 = w0;
+        s--;
     }
+}
+
+static inline void __memcpy_fwd(
+        unsigned char *d,
+        const unsigned char *s,
+        size_t n)
+{
+    if (n < MEM_COPY_SMALL) {
+        __memcpy_byte_fwd(d, s, n);
+        return;
+    }
+
+    //  Head: align the destination
+    size_t head = (MEM_WSIZE - ((uintptr_t)d % MEM_WSIZE)) % MEM_WSIZE;
+    __memcpy_byte_fwd(d, s, head);
+    d += head;
+    s += head;
+    n -= head;
+
+    //  Body
+    size_t nwords = n / MEM_WSIZE;
+    size_t offset = (uintptr_t)s % MEM_WSIZE;
+    __memcpy_word_fwd((mem_word_t*)d, (const mem_word_t*)(s - offset),
+            nwords, 8*offset, n >= MEM_COPY_PREFETCH_MIN);
+    d += nwords*MEM_WSIZE;
+    s += nwords*MEM_WSIZE;
+
+    //  Tail
+    __memcpy_byte_fwd(d, s, n % MEM_WSIZE);
+}
+
+static inline void __memcpy_bwd(
+        unsigned char *d,
+        const unsigned char *s,
+        size_t n)
+{
+    //  d and s point to the end of the buffers
+    if (n < MEM_COPY_SMALL) {
+        __memcpy_byte_bwd(d, s, n);
+        return;
+    }
+
+    //  Tail: align the end of the destination
+    size_t tail = (uintptr_t)d % MEM_WSIZE;
+    __memcpy_byte_bwd(d, s, tail);
+    d -= tail;
+    s -= tail;
+    n -= tail;
+
+    //  Body
+    size_t nwords = n / MEM_WSIZE;
+    size_t offset = (uintptr_t)s % MEM_WSIZE;
+    __memcpy_word_bwd((mem_word_t*)d, (const mem_word_t*)(s - offset),
+            nwords, 8*offset);
+    d -= nwords*MEM_WSIZE;
+    s -= nwords*MEM_WSIZE;
+
+    //  Head
+    __memcpy_byte_bwd(d, s, n % MEM_WSIZE);
+}
+
+void *memcpy(void *dest, const void *src, size_t n)
+{
+    __memcpy_fwd((unsigned char*)dest, (const unsigned char*)src, n);
+    return dest;
+}
+
+void *memmove(void *dest, const void *src, size_t n)
+{
+    unsigned char *d = (unsigned char*)dest;
+    const unsigned char *s = (const unsigned char*)src;
 
+    //  A forward copy is safe when the destination is below the source: each
+    //  source word is read before the destination word overlapping it is
+    //  written
+    if ((d == s) || (n == 0)) return dest;
+    if ((d < s) || (d >= s + n)) __memcpy_fwd(d, s, n);
+    else                         __memcpy_bwd(d + n, s + n, n);
     return dest;
 }
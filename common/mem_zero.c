@@ -0,0 +1,37 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/mem_zero.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines used to zero cache lines
+ *
+ *  It is kept apart from the memset and memcpy overrides (common/mem.c):
+ *  using it shall not pull them in when the C library ones are already
+ *  linked.
+ */
+#include <stdint.h>
+#include "common/cache.h"
+#include "common/mem.h"
+
+void mem_zero_lines(void *addr, size_t nlines)
+{
+    uintptr_t p = (uintptr_t)addr;
+    for (; nlines > 0; nlines--) {
+        cpu_dcache_zero_address(p);
+        p += BSP_CONFIG_DCACHE_LINE_BYTES;
+    }
+}
@@ -21,6 +21,8 @@
  *          multiple processor cores
  */
 #include "common/mp.h"
+#include "common/cpu.h"
+#include "common/cpu_defs.h"
 #include "bsp/bsp_config.h"
 
 #if (BSP_CONFIG_HARTID_BITS > 16)
@@ -35,12 +37,163 @@ volatile uint16_t cpu_hid2sid[1 << BSP_CONFIG_HARTID_BITS];
 volatile uint16_t cpu_sid2hid[1 << BSP_CONFIG_HARTID_BITS];
 volatile cpu_t    cpu_list[BSP_CONFIG_NCPUS];
 
+//
+//  Cluster of each logical CPU. By default, all CPUs are in the same cluster.
+//
+#ifndef BSP_CONFIG_CPU_CLUSTERS
+#define BSP_CONFIG_CPU_CLUSTERS { 0 }
+#endif
+
+static const uint8_t __mp_cpu_cluster[BSP_CONFIG_NCPUS] =
+        BSP_CONFIG_CPU_CLUSTERS;
+
+//
+//  Shared placement state. It is accessed with atomic operations.
+//
+static atomic_int __mp_next_cpu;
+static atomic_ulong __mp_release_seq;
+
 cpu_t* mp_get_free_cpu()
+{
+    return mp_get_free_cpu_in(NULL, MP_PLACE_FIRST);
+}
+
+static inline int __mp_in_set(const cpuset_t *set, int cpu_id)
+{
+    return (set == NULL) || cpuset_isempty(set) || cpuset_isset(set, cpu_id);
+}
+
+//
+//  First free CPU of the set, starting at the given one and wrapping around.
+//  If cluster is not negative, only CPUs of that cluster are considered.
+//
+static int __mp_scan(const cpuset_t *set, int start, int cluster)
 {
     for (int i = 0; i < BSP_CONFIG_NCPUS; i++) {
-        if (cpu_get_state(i) == CPU_IDLE) {
-            return (cpu_t*)cpu_get_desc(i);
+        int cpu = (start + i) % BSP_CONFIG_NCPUS;
+        if (!__mp_in_set(set, cpu)) continue;
+        if ((cluster >= 0) && (__mp_cpu_cluster[cpu] != cluster)) continue;
+        if (cpu_get_state(cpu) == CPU_IDLE) return cpu;
+    }
+    return -1;
+}
+
+static int __mp_scan_lru(const cpuset_t *set)
+{
+    int cpu = -1;
+    unsigned long oldest = 0;
+
+    for (int i = 0; i < BSP_CONFIG_NCPUS; i++) {
+        if (!__mp_in_set(set, i) || (cpu_get_state(i) != CPU_IDLE)) continue;
+
+        unsigned long seq = atomic_fetch_or(
+                (atomic_ulong*)&cpu_list[i].release_seq, 0);
+        if ((cpu < 0) || (seq < oldest)) {
+            cpu = i;
+            oldest = seq;
         }
     }
-    return NULL;
+    return cpu;
+}
+
+cpu_t* mp_get_free_cpu_in(const cpuset_t *set, enum mp_placement_e placement)
+{
+    int cpu = -1;
+    int start = atomic_fetch_or(&__mp_next_cpu, 0);
+
+    switch (placement) {
+        case MP_PLACE_ROUND_ROBIN:
+            cpu = __mp_scan(set, start, -1);
+            break;
+
+        case MP_PLACE_LRU:
+            cpu = __mp_scan_lru(set);
+            break;
+
+        case MP_PLACE_CLUSTER:
+            cpu = __mp_scan(set, start, mp_get_cpu_cluster(mp_get_self_sid()));
+            if (cpu < 0) cpu = __mp_scan(set, start, -1);
+            break;
+
+        case MP_PLACE_FIRST:
+        default:
+            cpu = __mp_scan(set, 0, -1);
+            break;
+    }
+
+    if (cpu < 0) return NULL;
+
+    //  Only the round-robin policies move the cursor
+    if ((placement == MP_PLACE_ROUND_ROBIN) ||
+            (placement == MP_PLACE_CLUSTER)) {
+        atomic_exchange(&__mp_next_cpu, (cpu + 1) % BSP_CONFIG_NCPUS);
+    }
+    return (cpu_t*)cpu_get_desc(cpu);
+}
+
+void mp_release_cpu(int cpu_id)
+{
+    unsigned long seq = atomic_fetch_add(&__mp_release_seq, 1) + 1;
+    atomic_exchange((atomic_ulong*)&cpu_list[cpu_id].release_seq, seq);
+
+    //  Make sure that the results of the thread are visible before declaring
+    //  the CPU as idle
+    cpu_dfence();
+    cpu_set_state(cpu_id, CPU_IDLE);
+}
+
+int mp_get_cpu_cluster(int cpu_id)
+{
+    if ((cpu_id < 0) || (cpu_id >= BSP_CONFIG_NCPUS)) return -1;
+    return __mp_cpu_cluster[cpu_id];
+}
+
+void mp_wakeup_cpu(int cpu_id)
+{
+#if BSP_CONFIG_NCPUS > 1
+    volatile cpu_t* cpu = cpu_get_desc(cpu_id);
+    int kind = CPU_IPI_NULL;
+
+    //  Make sure that previous writes are visible before waking up the target
+    cpu_dfence();
+    atomic_compare_exchange_strong((atomic_int*)&cpu->ipi_kind, &kind,
+            CPU_IPI_WAKEUP);
+    clint_send_ipi(cpu->clint_drv, cpu->hid);
+#endif
+}
+
+#if BSP_CONFIG_NCPUS > 1
+static void __mp_ack_wakeup()
+{
+    int hid = cpu_id();
+    int sid = cpu_hid2sid[hid];
+    int kind = CPU_IPI_WAKEUP;
+
+    clint_recv_ipi(cpu_list[sid].clint_drv, hid);
+    atomic_compare_exchange_strong((atomic_int*)&cpu_list[sid].ipi_kind,
+            &kind, CPU_IPI_NULL);
+}
+#endif
+
+void mp_wait_for_wakeup()
+{
+#if BSP_CONFIG_NCPUS > 1
+    //  The MSIP bit remains set until acknowledged. Thus, an IPI sent before
+    //  entering the loop is not lost.
+    while ((read_csr(mip) & MIP_MSIP) == 0) {
+        cpu_wait_for_interrupt();
+    }
+    __mp_ack_wakeup();
+#endif
+}
+
+int mp_poll_wakeup()
+{
+#if BSP_CONFIG_NCPUS > 1
+    if ((read_csr(mip) & MIP_MSIP) == 0) return 0;
+    __mp_ack_wakeup();
+    return 1;
+#else
+    return 0;
+#endif
 }
@@ -0,0 +1,153 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/mpmc_ring.c
+ *  @author Cesar Fuguet
+ *  @brief  Bounded lock-free multiple-producer/multiple-consumer ring buffer
+ */
+#include "common/mpmc_ring.h"
+#include "common/backoff.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+
+#define MPMC_RING_BACKOFF_MIN 8
+#define MPMC_RING_BACKOFF_MAX 512
+
+int mpmc_ring_init(mpmc_ring_t *r, mpmc_ring_cell_t *cell, size_t size)
+{
+    if ((size == 0) || ((size & (size - 1)) != 0)) return -1;
+
+    r->cell = cell;
+    r->mask = size - 1;
+    for (size_t i = 0; i < size; i++) {
+        atomic_store_uncached(&cell[i].seq, i);
+        atomic_store_uncached(&cell[i].data, 0);
+    }
+    atomic_store_uncached(&r->head, 0);
+    atomic_store_uncached(&r->tail, 0);
+
+    //  Make sure that the ring is visible
+    cpu_dfence();
+    return 0;
+}
+
+int mpmc_ring_push(mpmc_ring_t *r, void *item)
+{
+    unsigned long pos = atomic_load_uncached(&r->head);
+    mpmc_ring_cell_t *c;
+
+    for (;;) {
+        c = &r->cell[pos & r->mask];
+        long diff = (long)(atomic_load_uncached(&c->seq) - pos);
+        if (diff == 0) {
+            //  On failure, pos is updated with the current head
+            if (atomic_compare_exchange_weak(&r->head, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            //  The cell was not yet released by the consumer of the
+            //  previous lap: the ring is full
+            return -1;
+        } else {
+            pos = atomic_load_uncached(&r->head);
+        }
+    }
+
+    atomic_store_uncached(&c->data, (uintptr_t)item);
+    atomic_store_uncached(&c->seq, pos + 1);
+    return 0;
+}
+
+int mpmc_ring_pop(mpmc_ring_t *r, void **item)
+{
+    unsigned long pos = atomic_load_uncached(&r->tail);
+    mpmc_ring_cell_t *c;
+
+    for (;;) {
+        c = &r->cell[pos & r->mask];
+        long diff = (long)(atomic_load_uncached(&c->seq) - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak(&r->tail, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            //  The cell was not yet written: the ring is empty
+            return -1;
+        } else {
+            pos = atomic_load_uncached(&r->tail);
+        }
+    }
+
+    *item = (void*)atomic_load_uncached(&c->data);
+    atomic_store_uncached(&c->seq, pos + r->mask + 1);
+    return 0;
+}
+
+//
+//  Wait for a claimed cell to reach the expected sequence number. The cell
+//  was claimed by another CPU for the previous operation and this one is
+//  about to complete.
+//
+static inline void __mpmc_wait_seq(mpmc_ring_cell_t *c, unsigned long seq)
+{
+    backoff_t b;
+    backoff_init(&b, MPMC_RING_BACKOFF_MIN, MPMC_RING_BACKOFF_MAX);
+    while (atomic_load_uncached(&c->seq) != seq) backoff_exponential(&b);
+}
+
+size_t mpmc_ring_push_batch(mpmc_ring_t *r, void * const *items, size_t n)
+{
+    unsigned long pos = atomic_load_uncached(&r->head);
+
+    for (;;) {
+        //  Positions below the consumer index were claimed by consumers.
+        //  Read it after the producer index so that it is not behind it.
+        unsigned long tail = atomic_load_uncached(&r->tail);
+        long avail = (long)(mpmc_ring_size(r) - (pos - tail));
+        if (avail <= 0) return 0;
+        if ((long)n > avail) n = avail;
+
+        if (atomic_compare_exchange_weak(&r->head, &pos, pos + n)) break;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        mpmc_ring_cell_t *c = &r->cell[(pos + i) & r->mask];
+        __mpmc_wait_seq(c, pos + i);
+        atomic_store_uncached(&c->data, (uintptr_t)items[i]);
+        atomic_store_uncached(&c->seq, pos + i + 1);
+    }
+    return n;
+}
+
+size_t mpmc_ring_pop_batch(mpmc_ring_t *r, void **items, size_t n)
+{
+    unsigned long pos = atomic_load_uncached(&r->tail);
+
+    for (;;) {
+        //  Positions below the producer index were claimed by producers
+        unsigned long head = atomic_load_uncached(&r->head);
+        long avail = (long)(head - pos);
+        if (avail <= 0) return 0;
+        if ((long)n > avail) n = avail;
+
+        if (atomic_compare_exchange_weak(&r->tail, &pos, pos + n)) break;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        mpmc_ring_cell_t *c = &r->cell[(pos + i) & r->mask];
+        __mpmc_wait_seq(c, pos + i + 1);
+        items[i] = (void*)atomic_load_uncached(&c->data);
+        atomic_store_uncached(&c->seq, pos + i + r->mask + 1);
+    }
+    return n;
+}
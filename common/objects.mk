@@ -19,13 +19,37 @@
 #  @author Cesar Fuguet
 ##
 common-objs-y =
+common-objs-y += $(O)/common/arena.o
+common-objs-y += $(O)/common/barrier.o
 common-objs-y += $(O)/common/bitset.o
+common-objs-y += $(O)/common/chan.o
+common-objs-y += $(O)/common/collective.o
+common-objs-y += $(O)/common/condvar.o
 common-objs-y += $(O)/common/fifobuf.o
+common-objs-y += $(O)/common/mcs_mutex.o
 common-objs-y += $(O)/common/mem.o
+common-objs-y += $(O)/common/mem_zero.o
 common-objs-y += $(O)/common/mp.o
+common-objs-y += $(O)/common/mpmc_ring.o
+common-objs-y += $(O)/common/parallel.o
+common-objs-y += $(O)/common/percpu.o
+common-objs-y += $(O)/common/rw_mutex.o
+common-objs-y += $(O)/common/semaphore.o
+common-objs-y += $(O)/common/seqlock.o
+common-objs-y += $(O)/common/sleep_mutex.o
 common-objs-y += $(O)/common/spin_mutex.o
+common-objs-y += $(O)/common/spsc_ring.o
+common-objs-y += $(O)/common/str.o
+common-objs-y += $(O)/common/str_rvv.o
 common-objs-y += $(O)/common/syscall.o
+common-objs-y += $(O)/common/task.o
+common-objs-y += $(O)/common/task_graph.o
+common-objs-y += $(O)/common/thread_pool.o
 common-objs-y += $(O)/common/threads.o
 common-objs-y += $(O)/common/ticket_mutex.o
+common-objs-y += $(O)/common/tls.o
 common-objs-y += $(O)/common/trap_entry.o
 common-objs-y += $(O)/common/trap_handler.o
+common-objs-y += $(O)/common/uthread.o
+common-objs-y += $(O)/common/uthread_switch.o
+common-objs-y += $(O)/common/waitq.o
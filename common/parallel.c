@@ -0,0 +1,207 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/parallel.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the fork-join routines used to distribute
+ *          loop iterations across all the CPUs of the platform
+ */
+#include <stdatomic.h>
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/mp.h"
+#include "common/parallel.h"
+
+typedef struct parallel_for_desc_s
+{
+    long begin;
+    long end;
+    long chunk;
+    long nchunks;
+    int  ncpus;
+    enum parallel_sched_e sched;
+    parallel_for_func_t func;
+    void *args;
+
+    /* Next chunk to be claimed (dynamic scheduling) */
+    atomic_long next __cl_aligned__;
+} parallel_for_desc_t;
+
+typedef struct parallel_for_rank_s
+{
+    parallel_for_desc_t *desc;
+    int rank;
+} __cl_aligned__ parallel_for_rank_t;
+
+static thread_pool_t __parallel_pool;
+static int __parallel_initialized = 0;
+static enum parallel_sched_e __parallel_sched = PARALLEL_SCHED_STATIC;
+
+static inline void __parallel_for_chunk(parallel_for_desc_t *d, long c)
+{
+    long b = d->begin + c*d->chunk;
+    long e = (d->end - b > d->chunk) ? b + d->chunk : d->end;
+    d->func(b, e, d->args);
+}
+
+static void __parallel_for_run(parallel_for_desc_t *d, int rank)
+{
+    switch (d->sched) {
+        case PARALLEL_SCHED_STATIC: {
+            long q = d->nchunks / d->ncpus;
+            long r = d->nchunks % d->ncpus;
+            long first = rank*q + (rank < r ? rank : r);
+            long count = q + (rank < r ? 1 : 0);
+            if (count == 0) break;
+
+            long b = d->begin + first*d->chunk;
+            long e = ((d->end - b) / d->chunk > count) ?
+                    b + count*d->chunk : d->end;
+            d->func(b, e, d->args);
+            break;
+        }
+
+        case PARALLEL_SCHED_ROUND_ROBIN:
+            for (long c = rank; c < d->nchunks; c += d->ncpus) {
+                __parallel_for_chunk(d, c);
+            }
+            break;
+
+        case PARALLEL_SCHED_DYNAMIC:
+            for (;;) {
+                long c = atomic_fetch_add(&d->next, 1);
+                if (c >= d->nchunks) break;
+                __parallel_for_chunk(d, c);
+            }
+            break;
+    }
+}
+
+static int __parallel_for_worker(void *args)
+{
+    //  If there is no hardware cache coherency, make sure that the loop
+    //  descriptors (written by the director thread) are not cached
+    cpu_dcache_invalidate_range((uintptr_t)args, sizeof(parallel_for_rank_t));
+
+    parallel_for_rank_t *r = (parallel_for_rank_t*)args;
+    cpu_dcache_invalidate_range((uintptr_t)r->desc, sizeof(parallel_for_desc_t));
+
+    __parallel_for_run(r->desc, r->rank);
+    return THREAD_SUCCESS;
+}
+
+int parallel_init(int flags)
+{
+    if (__parallel_initialized) return parallel_get_ncpus();
+
+    //  When some CPUs are busy, claim only those that are idle
+    if (thread_pool_init(&__parallel_pool, -1, flags) != 0) {
+        int nidle = 0;
+        for (int i = 0; i < mp_get_cpu_count(); i++) {
+            if (i == mp_get_self_sid()) continue;
+            if (cpu_get_state(i) == CPU_IDLE) nidle++;
+        }
+
+        //  When worker threads cannot be created, parallel loops are executed
+        //  by the calling CPU only, and the initialization is retried on the
+        //  next call
+        if ((nidle == 0) ||
+                (thread_pool_init(&__parallel_pool, nidle, flags) != 0)) {
+            return 1;
+        }
+    }
+
+    __parallel_initialized = 1;
+    return parallel_get_ncpus();
+}
+
+int parallel_fini()
+{
+    if (!__parallel_initialized) return 0;
+
+    __parallel_initialized = 0;
+    return thread_pool_destroy(&__parallel_pool);
+}
+
+int parallel_get_ncpus()
+{
+    if (!__parallel_initialized) return 1;
+    return thread_pool_size(&__parallel_pool) + 1;
+}
+
+void parallel_set_sched(enum parallel_sched_e sched)
+{
+    __parallel_sched = sched;
+}
+
+int parallel_for(long begin, long end, long chunk,
+        parallel_for_func_t func, void *args)
+{
+    return parallel_for_sched(__parallel_sched, begin, end, chunk, func, args);
+}
+
+int parallel_for_sched(enum parallel_sched_e sched,
+        long begin, long end, long chunk,
+        parallel_for_func_t func, void *args)
+{
+    parallel_for_desc_t desc;
+    parallel_for_rank_t rank[BSP_CONFIG_NCPUS];
+
+    if (end <= begin) return 0;
+    if (chunk <= 0) chunk = 1;
+
+    parallel_init(THREAD_POOL_WFI);
+
+    desc.begin   = begin;
+    desc.end     = end;
+    desc.chunk   = chunk;
+    desc.nchunks = (end - begin) / chunk + ((end - begin) % chunk != 0);
+    desc.ncpus   = parallel_get_ncpus();
+    desc.sched   = sched;
+    desc.func    = func;
+    desc.args    = args;
+    atomic_exchange(&desc.next, 0);
+
+    //  Never wake-up more CPUs than chunks
+    int nworkers = desc.ncpus - 1;
+    if (desc.nchunks < desc.ncpus) {
+        nworkers = desc.nchunks - 1;
+        if (sched != PARALLEL_SCHED_DYNAMIC) desc.ncpus = desc.nchunks;
+    }
+
+    for (int i = 0; i < nworkers; i++) {
+        rank[i].desc = &desc;
+        rank[i].rank = i + 1;
+    }
+
+    //  Make sure that loop descriptors are visible
+    cpu_dfence();
+
+    for (int i = 0; i < nworkers; i++) {
+        thread_pool_submit(&__parallel_pool, i, __parallel_for_worker,
+                &rank[i]);
+    }
+
+    //  The calling CPU participates as rank 0
+    __parallel_for_run(&desc, 0);
+
+    int ret = 0;
+    for (int i = 0; i < nworkers; i++) {
+        if (thread_pool_wait(&__parallel_pool, i) != THREAD_SUCCESS) ret = -1;
+    }
+    return ret;
+}
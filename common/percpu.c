@@ -0,0 +1,70 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/percpu.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines used to allocate the per-CPU
+ *          variables
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bsp/bsp_config.h"
+#include "common/cache.h"
+#include "common/compiler.h"
+#include "common/cpu.h"
+#include "common/percpu.h"
+
+//
+//  Template of the per-CPU copies (see linkcmds.include)
+//
+extern char _spercpu[];
+extern char _epercpu[];
+extern char _percpu_align[];
+
+//
+//  Offsets are written once at boot, before secondary CPUs are started, and
+//  read-only afterwards. They can be cached.
+//
+uintptr_t __percpu_offset[BSP_CONFIG_NCPUS] __CACHED__;
+
+int percpu_init()
+{
+    size_t bytes = (uintptr_t)_epercpu - (uintptr_t)_spercpu;
+    size_t align = (uintptr_t)_percpu_align;
+    if (align < BSP_CONFIG_DCACHE_LINE_BYTES) {
+        align = BSP_CONFIG_DCACHE_LINE_BYTES;
+    }
+
+    //  No per-CPU variables
+    size_t stride = (bytes + align - 1) & ~(align - 1);
+    if (stride == 0) return 0;
+
+    void *p = malloc(stride*BSP_CONFIG_NCPUS + align - 1);
+    if (p == NULL) return -1;
+
+    uintptr_t base = ((uintptr_t)p + align - 1) & ~(align - 1);
+    for (int i = 0; i < BSP_CONFIG_NCPUS; i++) {
+        uintptr_t copy = base + i*stride;
+        memcpy((void*)copy, _spercpu, bytes);
+        __percpu_offset[i] = copy - (uintptr_t)_spercpu;
+    }
+
+    //  Make sure that the per-CPU copies are visible
+    cpu_dfence();
+    return 0;
+}
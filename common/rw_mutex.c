@@ -0,0 +1,156 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/rw_mutex.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          reader-writer mutexes
+ */
+#include "common/rw_mutex.h"
+#include "common/backoff.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/mp.h"
+
+#ifndef RW_MUTEX_BACKOFF_MIN
+#define RW_MUTEX_BACKOFF_MIN 16
+#endif
+#ifndef RW_MUTEX_BACKOFF_MAX
+#define RW_MUTEX_BACKOFF_MAX 2048
+#endif
+
+static int __rw_mutex_has_readers(rw_mutex_t *m)
+{
+    for (int i = 0; i < BSP_CONFIG_NCPUS; i++) {
+        if (atomic_load_uncached(&m->reader[i].count)) return 1;
+    }
+    return 0;
+}
+
+static inline atomic_int* __rw_mutex_self(rw_mutex_t *m)
+{
+    return &m->reader[mp_get_self_sid()].count;
+}
+
+void rw_mutex_init(rw_mutex_t *m, enum rw_mutex_pref_e pref)
+{
+    for (int i = 0; i < BSP_CONFIG_NCPUS; i++) {
+        atomic_exchange(&m->reader[i].count, 0);
+    }
+    atomic_exchange(&m->writer, 0);
+    atomic_exchange(&m->wwait, 0);
+    m->pref = pref;
+    cpu_dfence();
+}
+
+void rw_mutex_destroy(rw_mutex_t *m)
+{
+}
+
+void rw_mutex_read_lock(rw_mutex_t *m)
+{
+    atomic_int *self = __rw_mutex_self(m);
+    backoff_t b;
+    backoff_init(&b, RW_MUTEX_BACKOFF_MIN, RW_MUTEX_BACKOFF_MAX);
+
+    cpu_dfence();
+    if (m->pref == RW_MUTEX_PREFER_READER) {
+        //  Announce the reader, then wait for the current writer (if any) to
+        //  leave. Writers do not enter while there are readers.
+        atomic_fetch_add(self, 1);
+        while (atomic_load_uncached(&m->writer)) backoff_exponential(&b);
+        return;
+    }
+
+    for (;;) {
+        //  Let waiting writers go first
+        while (atomic_load_uncached(&m->wwait) || atomic_load_uncached(&m->writer)) {
+            backoff_exponential(&b);
+        }
+
+        atomic_fetch_add(self, 1);
+        if (atomic_load_uncached(&m->writer) == 0) return;
+
+        //  A writer entered in the meantime: retry
+        atomic_fetch_sub(self, 1);
+    }
+}
+
+int rw_mutex_read_trylock(rw_mutex_t *m)
+{
+    atomic_int *self = __rw_mutex_self(m);
+
+    cpu_dfence();
+    if ((m->pref == RW_MUTEX_PREFER_WRITER) && atomic_load_uncached(&m->wwait)) return 0;
+
+    atomic_fetch_add(self, 1);
+    if (atomic_load_uncached(&m->writer) == 0) return 1;
+
+    atomic_fetch_sub(self, 1);
+    return 0;
+}
+
+void rw_mutex_read_unlock(rw_mutex_t *m)
+{
+    cpu_dfence();
+    atomic_fetch_sub(__rw_mutex_self(m), 1);
+}
+
+void rw_mutex_write_lock(rw_mutex_t *m)
+{
+    backoff_t b;
+    backoff_init(&b, RW_MUTEX_BACKOFF_MIN, RW_MUTEX_BACKOFF_MAX);
+
+    cpu_dfence();
+    if (m->pref == RW_MUTEX_PREFER_READER) {
+        //  Enter only when there is no reader
+        for (;;) {
+            while (__rw_mutex_has_readers(m)) backoff_exponential(&b);
+            if (atomic_exchange(&m->writer, 1) == 0) {
+                if (__rw_mutex_has_readers(m) == 0) return;
+                atomic_exchange(&m->writer, 0);
+            }
+            backoff_exponential(&b);
+        }
+    }
+
+    //  Block new readers, get the exclusive writer flag and wait for the
+    //  current readers to leave
+    atomic_fetch_add(&m->wwait, 1);
+    while (atomic_exchange(&m->writer, 1) == 1) backoff_exponential(&b);
+    atomic_fetch_sub(&m->wwait, 1);
+
+    backoff_init(&b, RW_MUTEX_BACKOFF_MIN, RW_MUTEX_BACKOFF_MAX);
+    while (__rw_mutex_has_readers(m)) backoff_exponential(&b);
+}
+
+int rw_mutex_write_trylock(rw_mutex_t *m)
+{
+    cpu_dfence();
+    if (__rw_mutex_has_readers(m)) return 0;
+    if (atomic_exchange(&m->writer, 1) == 1) return 0;
+    if (__rw_mutex_has_readers(m) == 0) return 1;
+
+    atomic_exchange(&m->writer, 0);
+    return 0;
+}
+
+void rw_mutex_write_unlock(rw_mutex_t *m)
+{
+    cpu_dfence();
+    atomic_exchange(&m->writer, 0);
+}
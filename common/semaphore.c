@@ -0,0 +1,73 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/semaphore.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          counting semaphores
+ */
+#include "common/semaphore.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+
+void semaphore_init(semaphore_t *s, int count)
+{
+    atomic_store_uncached(&s->count, count);
+    waitq_init(&s->waitq);
+}
+
+void semaphore_destroy(semaphore_t *s)
+{
+    waitq_destroy(&s->waitq);
+}
+
+int semaphore_trywait(semaphore_t *s)
+{
+    int count = atomic_load_uncached(&s->count);
+    while (count > 0) {
+        if (atomic_compare_exchange_weak(&s->count, &count, count - 1)) {
+            cpu_dfence();
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void semaphore_wait(semaphore_t *s)
+{
+    for (;;) {
+        if (semaphore_trywait(s)) return;
+        waitq_prepare(&s->waitq);
+        if (semaphore_trywait(s)) {
+            waitq_cancel(&s->waitq);
+            return;
+        }
+        waitq_wait(&s->waitq);
+    }
+}
+
+void semaphore_post(semaphore_t *s)
+{
+    cpu_dfence();
+    atomic_fetch_add(&s->count, 1);
+    waitq_wake_one(&s->waitq);
+}
+
+int semaphore_get_count(semaphore_t *s)
+{
+    return atomic_load_uncached(&s->count);
+}
@@ -0,0 +1,92 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/seqlock.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          sequence locks
+ */
+#include "common/seqlock.h"
+#include "common/backoff.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+
+#ifndef SEQLOCK_BACKOFF_MIN
+#define SEQLOCK_BACKOFF_MIN 16
+#endif
+#ifndef SEQLOCK_BACKOFF_MAX
+#define SEQLOCK_BACKOFF_MAX 1024
+#endif
+
+void seqlock_init(seqlock_t *s, void *data, size_t bytes)
+{
+    atomic_store_uncached(&s->seq, 0);
+    s->data  = data;
+    s->bytes = (data != NULL) ? bytes : 0;
+    cpu_dfence();
+}
+
+void seqlock_destroy(seqlock_t *s)
+{
+}
+
+void seqlock_write_lock(seqlock_t *s)
+{
+    backoff_t b;
+    backoff_init(&b, SEQLOCK_BACKOFF_MIN, SEQLOCK_BACKOFF_MAX);
+
+    //  An even sequence number means that no write is in progress. The
+    //  writer makes it odd.
+    for (;;) {
+        unsigned seq = atomic_load_uncached(&s->seq);
+        if (((seq & 1) == 0) &&
+                atomic_compare_exchange_strong(&s->seq, &seq, seq + 1)) {
+            break;
+        }
+        backoff_exponential(&b);
+    }
+    cpu_dfence();
+}
+
+void seqlock_write_unlock(seqlock_t *s)
+{
+    cpu_dfence();
+    atomic_fetch_add(&s->seq, 1);
+}
+
+unsigned seqlock_read_begin(seqlock_t *s)
+{
+    backoff_t b;
+    unsigned seq;
+
+    backoff_init(&b, SEQLOCK_BACKOFF_MIN, SEQLOCK_BACKOFF_MAX);
+    while ((seq = atomic_load_uncached(&s->seq)) & 1) {
+        backoff_exponential(&b);
+    }
+
+    //  If there is no hardware cache coherency, make sure that the protected
+    //  data is not cached
+    cpu_dfence();
+    cpu_dcache_invalidate_range((uintptr_t)s->data, s->bytes);
+    return seq;
+}
+
+int seqlock_read_retry(seqlock_t *s, unsigned seq)
+{
+    cpu_dfence();
+    return (atomic_load_uncached(&s->seq) != seq);
+}
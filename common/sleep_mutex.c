@@ -0,0 +1,84 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/sleep_mutex.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          sleeping mutexes
+ */
+#include "common/sleep_mutex.h"
+#include "common/backoff.h"
+#include "common/cpu.h"
+
+//
+//  Number of (backoff) attempts before sleeping
+//
+#ifndef SLEEP_MUTEX_SPIN_COUNT
+#define SLEEP_MUTEX_SPIN_COUNT 8
+#endif
+#ifndef SLEEP_MUTEX_BACKOFF_MIN
+#define SLEEP_MUTEX_BACKOFF_MIN 16
+#endif
+#ifndef SLEEP_MUTEX_BACKOFF_MAX
+#define SLEEP_MUTEX_BACKOFF_MAX 1024
+#endif
+
+void sleep_mutex_init(sleep_mutex_t *m)
+{
+    atomic_exchange(&m->lock, 0);
+    waitq_init(&m->waitq);
+}
+
+void sleep_mutex_destroy(sleep_mutex_t *m)
+{
+    waitq_destroy(&m->waitq);
+}
+
+void sleep_mutex_lock(sleep_mutex_t *m)
+{
+    backoff_t b;
+    backoff_init(&b, SLEEP_MUTEX_BACKOFF_MIN, SLEEP_MUTEX_BACKOFF_MAX);
+
+    cpu_dfence();
+    for (int i = 0; i < SLEEP_MUTEX_SPIN_COUNT; i++) {
+        if (atomic_exchange(&m->lock, 1) == 0) return;
+        backoff_exponential(&b);
+    }
+
+    for (;;) {
+        if (atomic_exchange(&m->lock, 1) == 0) return;
+        waitq_prepare(&m->waitq);
+        if (atomic_exchange(&m->lock, 1) == 0) {
+            waitq_cancel(&m->waitq);
+            return;
+        }
+        waitq_wait(&m->waitq);
+    }
+}
+
+int sleep_mutex_trylock(sleep_mutex_t *m)
+{
+    cpu_dfence();
+    return (atomic_exchange(&m->lock, 1) == 0);
+}
+
+void sleep_mutex_unlock(sleep_mutex_t *m)
+{
+    cpu_dfence();
+    atomic_exchange(&m->lock, 0);
+    waitq_wake_one(&m->waitq);
+}
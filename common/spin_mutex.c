@@ -22,9 +22,19 @@
  *          mutexes (mutual exclusion locks)
  */
 #include "common/spin_mutex.h"
+#include "common/backoff.h"
 #include "common/cpu.h"
 
-#define MUTEX_WAIT_DELAY 500
+//
+//  Exponential backoff parameters (in cycles). A fixed delay is obtained
+//  when the minimum and the maximum are equal.
+//
+#ifndef SPIN_MUTEX_BACKOFF_MIN
+#define SPIN_MUTEX_BACKOFF_MIN 16
+#endif
+#ifndef SPIN_MUTEX_BACKOFF_MAX
+#define SPIN_MUTEX_BACKOFF_MAX 2048
+#endif
 
 void spin_mutex_init(spin_mutex_t *m)
 {
@@ -37,9 +47,12 @@ void spin_mutex_destroy(spin_mutex_t *m)
 
 void spin_mutex_lock(spin_mutex_t *m)
 {
+    backoff_t b;
+    backoff_init(&b, SPIN_MUTEX_BACKOFF_MIN, SPIN_MUTEX_BACKOFF_MAX);
+
     cpu_dfence();
     while(atomic_exchange(&m->lock, 1) == 1) {
-        cpu_delay(MUTEX_WAIT_DELAY);
+        backoff_exponential(&b);
     }
 }
 
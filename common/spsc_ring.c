@@ -0,0 +1,106 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/spsc_ring.c
+ *  @author Cesar Fuguet
+ *  @brief  Bounded lock-free single-producer/single-consumer ring buffer
+ */
+#include "common/spsc_ring.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+
+int spsc_ring_init(spsc_ring_t *r, atomic_uintptr_t *buf, size_t size)
+{
+    if ((size == 0) || ((size & (size - 1)) != 0)) return -1;
+
+    r->buf  = buf;
+    r->mask = size - 1;
+    r->prod.head       = 0;
+    r->prod.tail_cache = 0;
+    r->cons.tail       = 0;
+    r->cons.head_cache = 0;
+    atomic_store_uncached(&r->head, 0);
+    atomic_store_uncached(&r->tail, 0);
+
+    //  Make sure that the ring is visible
+    cpu_dfence();
+    return 0;
+}
+
+size_t spsc_ring_push_batch(spsc_ring_t *r, void * const *items, size_t n)
+{
+    unsigned long h = r->prod.head;
+    size_t avail = spsc_ring_size(r) - (h - r->prod.tail_cache);
+
+    if (avail < n) {
+        //  Refresh the copy of the consumer index
+        r->prod.tail_cache = atomic_load_uncached(&r->tail);
+        avail = spsc_ring_size(r) - (h - r->prod.tail_cache);
+    }
+    if (n > avail) n = avail;
+    if (n == 0) return 0;
+
+    for (size_t i = 0; i < n; i++) {
+        atomic_store_uncached(&r->buf[(h + i) & r->mask], (uintptr_t)items[i]);
+    }
+
+    //  Make sure that the items are visible before publishing them
+    cpu_dfence();
+    r->prod.head = h + n;
+    atomic_store_uncached(&r->head, h + n);
+    return n;
+}
+
+size_t spsc_ring_pop_batch(spsc_ring_t *r, void **items, size_t n)
+{
+    unsigned long t = r->cons.tail;
+    size_t avail = r->cons.head_cache - t;
+
+    if (avail < n) {
+        //  Refresh the copy of the producer index
+        r->cons.head_cache = atomic_load_uncached(&r->head);
+        avail = r->cons.head_cache - t;
+    }
+    if (n > avail) n = avail;
+    if (n == 0) return 0;
+
+    for (size_t i = 0; i < n; i++) {
+        items[i] = (void*)atomic_load_uncached(&r->buf[(t + i) & r->mask]);
+    }
+
+    //  Release the slots
+    r->cons.tail = t + n;
+    atomic_store_uncached(&r->tail, t + n);
+    return n;
+}
+
+int spsc_ring_push(spsc_ring_t *r, void *item)
+{
+    return (spsc_ring_push_batch(r, &item, 1) == 1) ? 0 : -1;
+}
+
+int spsc_ring_pop(spsc_ring_t *r, void **item)
+{
+    return (spsc_ring_pop_batch(r, item, 1) == 1) ? 0 : -1;
+}
+
+size_t spsc_ring_count(spsc_ring_t *r)
+{
+    //  Read the consumer index first: the producer index cannot be behind it
+    unsigned long t = atomic_load_uncached(&r->tail);
+    return atomic_load_uncached(&r->head) - t;
+}
@@ -0,0 +1,142 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/str.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the optimized routines for string and memory
+ *          comparison and search
+ *
+ *  Words are processed at once (SIMD within a register). When the target
+ *  supports the vector extension (ARCH contains 'v'), the vector versions
+ *  of common/str_rvv.S are used instead.
+ */
+#ifndef __riscv_vector
+#include <stdint.h>
+#include <string.h>
+#include "common/compiler.h"
+
+#define STR_WSIZE sizeof(unsigned long)
+
+typedef unsigned long __attribute__((__may_alias__)) str_word_t;
+
+//
+//  Word with the given byte replicated in all its bytes
+//
+static inline unsigned long __str_repeat(unsigned char c)
+{
+    return (unsigned long)c * (~0UL / 0xff);
+}
+
+//
+//  Non-zero if one of the bytes of the word is zero
+//
+static inline unsigned long __str_has_zero(unsigned long w)
+{
+    return (w - __str_repeat(0x01)) & ~w & __str_repeat(0x80);
+}
+
+static inline int __str_is_aligned(const void *p)
+{
+    return ((uintptr_t)p % STR_WSIZE) == 0;
+}
+
+__NO_LIBCALL__ size_t strlen(const char *s)
+{
+    const char *p = s;
+
+    //  Head: align the pointer. Aligned word loads never cross a page (or a
+    //  memory region) boundary, so reading past the terminating byte is
+    //  safe.
+    for (; !__str_is_aligned(p); p++) {
+        if (*p == '\0') return p - s;
+    }
+
+    const str_word_t *w = (const str_word_t*)p;
+    while (!__str_has_zero(*w)) w++;
+
+    for (p = (const char*)w; *p != '\0'; p++);
+    return p - s;
+}
+
+__NO_LIBCALL__ void *memchr(const void *s, int c, size_t n)
+{
+    const unsigned char *p = (const unsigned char*)s;
+    const unsigned char uc = (unsigned char)c;
+
+    for (; (n > 0) && !__str_is_aligned(p); n--, p++) {
+        if (*p == uc) return (void*)p;
+    }
+
+    const unsigned long pattern = __str_repeat(uc);
+    for (; n >= STR_WSIZE; n -= STR_WSIZE, p += STR_WSIZE) {
+        if (__str_has_zero(*(const str_word_t*)p ^ pattern)) break;
+    }
+
+    for (; n > 0; n--, p++) {
+        if (*p == uc) return (void*)p;
+    }
+    return NULL;
+}
+
+__NO_LIBCALL__ int memcmp(const void *s1, const void *s2, size_t n)
+{
+    const unsigned char *p1 = (const unsigned char*)s1;
+    const unsigned char *p2 = (const unsigned char*)s2;
+
+    //  Words are compared when both buffers have the same alignment
+    if (((uintptr_t)p1 % STR_WSIZE) == ((uintptr_t)p2 % STR_WSIZE)) {
+        for (; (n > 0) && !__str_is_aligned(p1); n--, p1++, p2++) {
+            if (*p1 != *p2) return *p1 - *p2;
+        }
+        for (; n >= STR_WSIZE; n -= STR_WSIZE) {
+            if (*(const str_word_t*)p1 != *(const str_word_t*)p2) break;
+            p1 += STR_WSIZE;
+            p2 += STR_WSIZE;
+        }
+    }
+
+    //  Tail, or first different word
+    for (; n > 0; n--, p1++, p2++) {
+        if (*p1 != *p2) return *p1 - *p2;
+    }
+    return 0;
+}
+
+__NO_LIBCALL__ int strcmp(const char *s1, const char *s2)
+{
+    const unsigned char *p1 = (const unsigned char*)s1;
+    const unsigned char *p2 = (const unsigned char*)s2;
+
+    //  Words are compared when both strings have the same alignment
+    if (((uintptr_t)p1 % STR_WSIZE) == ((uintptr_t)p2 % STR_WSIZE)) {
+        for (; !__str_is_aligned(p1); p1++, p2++) {
+            if ((*p1 == '\0') || (*p1 != *p2)) return *p1 - *p2;
+        }
+        for (;;) {
+            unsigned long w1 = *(const str_word_t*)p1;
+            unsigned long w2 = *(const str_word_t*)p2;
+            if ((w1 != w2) || __str_has_zero(w1)) break;
+            p1 += STR_WSIZE;
+            p2 += STR_WSIZE;
+        }
+    }
+
+    //  Unaligned strings, or word containing the difference or the end
+    for (; (*p1 != '\0') && (*p1 == *p2); p1++, p2++);
+    return *p1 - *p2;
+}
+#endif /* __riscv_vector */
@@ -19,11 +19,17 @@
  *  @author Cesar Fuguet
  */
 #include "common/syscall.h"
+#include "common/cache.h"
 #include "common/compiler.h"
+#include "common/heap.h"
 #include "common/ticket_mutex.h"
 #include "common/threads.h"
 #include "common/cpu.h"
+#include "common/cpu_defs.h"
+#include "common/mp.h"
 #include "bsp/bsp_config.h"
+#include <errno.h>
+#include <stdatomic.h>
 #include <sys/times.h>
 #include <sys/time.h>
 #include <sys/reent.h>
@@ -34,17 +40,97 @@ void (*_putchar)(char c)         = NULL;
 int  (*_getchar)()               = NULL;
 void (*_tohost_exit)(int status) = NULL;
 
+//
+//  The heap break is moved with a CAS: CPUs can extend the heap concurrently
+//  without a lock. The heap is bounded by _heap_end (see linkcmds.include).
+//
+extern char _end[];
+extern char _heap_end[];
+
+static atomic_uintptr_t __sbrk_heap;
+static atomic_uintptr_t __sbrk_peak;
+static atomic_ulong __sbrk_calls;
+static atomic_ulong __sbrk_failures;
+
 void *_sbrk(int incr)
 {
-    extern int _end;
-    static unsigned char *heap = NULL;
-    unsigned char *prev_heap;
+    uintptr_t curr = atomic_load_uncached(&__sbrk_heap);
+    uintptr_t prev_heap, heap;
+
+    atomic_fetch_add(&__sbrk_calls, 1);
+    do {
+        //  The break is zero before the first call
+        prev_heap = (curr != 0) ? curr : (uintptr_t)_end;
+
+        heap = prev_heap + incr;
+        if ((incr > 0) ? (heap > (uintptr_t)_heap_end || heap < prev_heap)
+                       : (heap < (uintptr_t)_end || heap > prev_heap)) {
+            atomic_fetch_add(&__sbrk_failures, 1);
+            errno = ENOMEM;
+            return (void*)-1;
+        }
+    } while (!atomic_compare_exchange_weak(&__sbrk_heap, &curr, heap));
 
-    if (heap == NULL) heap = (unsigned char*)&_end;
+    //  Update the high-water mark
+    uintptr_t peak = atomic_load_uncached(&__sbrk_peak);
+    while ((heap > peak) &&
+            !atomic_compare_exchange_weak(&__sbrk_peak, &peak, heap));
+
+    return (void*)prev_heap;
+}
+
+void heap_get_stats(heap_stats_t *stats)
+{
+    uintptr_t heap = atomic_load_uncached(&__sbrk_heap);
+    uintptr_t peak = atomic_load_uncached(&__sbrk_peak);
+
+    stats->limit         = (uintptr_t)_heap_end - (uintptr_t)_end;
+    stats->size          = (heap != 0) ? heap - (uintptr_t)_end : 0;
+    stats->peak          = (peak != 0) ? peak - (uintptr_t)_end : 0;
+    stats->sbrk_calls    = atomic_load_uncached(&__sbrk_calls);
+    stats->sbrk_failures = atomic_load_uncached(&__sbrk_failures);
+}
 
-    prev_heap = heap;
-    heap += incr;
-    return prev_heap;
+//
+//  Locking hooks of the newlib's allocator. The lock is recursive because the
+//  allocator may re-enter it (e.g. realloc calling malloc). The owner is the
+//  CPU: interrupts are masked while the lock is held, so that neither an
+//  interrupt handler nor another (preempting) user-level thread of the same
+//  CPU enters the allocator and is mistaken for a recursive call.
+//
+static ticket_mutex_t __malloc_mutex;
+static atomic_int __malloc_owner;
+static int __malloc_depth;
+static uintptr_t __malloc_mie;
+
+void __malloc_lock(struct _reent *r)
+{
+    int self = mp_get_self_sid() + 1;
+
+    (void)r;
+    if (atomic_load_uncached(&__malloc_owner) != self) {
+        uintptr_t mie = read_csr(mstatus) & MSTATUS_MIE;
+        cpu_disable_interrupts();
+        ticket_mutex_lock(&__malloc_mutex);
+
+        //  The heap is cacheable. If there is no hardware cache coherency,
+        //  discard the allocator state cached before other CPUs updated it.
+        cpu_dcache_invalidate();
+        atomic_store_uncached(&__malloc_owner, self);
+        __malloc_mie = mie;
+    }
+    __malloc_depth++;
+}
+
+void __malloc_unlock(struct _reent *r)
+{
+    (void)r;
+    if (--__malloc_depth == 0) {
+        uintptr_t mie = __malloc_mie;
+        atomic_store_uncached(&__malloc_owner, 0);
+        ticket_mutex_unlock(&__malloc_mutex);
+        if (mie) cpu_enable_interrupts();
+    }
 }
 
 int _close(int file)
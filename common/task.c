@@ -0,0 +1,194 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/task.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures of the
+ *          work-stealing task runtime
+ */
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/mp.h"
+#include "common/task.h"
+
+#if (TASK_DEQUE_SIZE & (TASK_DEQUE_SIZE - 1)) != 0
+#error "TASK_DEQUE_SIZE shall be a power of 2"
+#endif
+
+#define TASK_DEQUE_MASK   (TASK_DEQUE_SIZE - 1)
+#define TASK_IDLE_DELAY   200
+
+static task_deque_t __task_deque[BSP_CONFIG_NCPUS];
+static thread_pool_t __task_pool;
+static atomic_int __task_stop;
+
+//
+//  Chase-Lev work-stealing deque
+//
+//  Only the owner CPU pushes and takes from the bottom. Thieves steal from the
+//  top. Conflicts on the last element are resolved with a CAS on top.
+//
+static int __task_deque_push(task_deque_t *d, task_t *t)
+{
+    long b = atomic_load_uncached(&d->bottom);
+    long top = atomic_load_uncached(&d->top);
+    if (b - top >= TASK_DEQUE_SIZE) return -1;
+
+    atomic_store_uncached(&d->buf[b & TASK_DEQUE_MASK], (uintptr_t)t);
+    cpu_dfence();
+    atomic_store_uncached(&d->bottom, b + 1);
+    return 0;
+}
+
+static task_t* __task_deque_take(task_deque_t *d)
+{
+    long b = atomic_load_uncached(&d->bottom) - 1;
+    atomic_store_uncached(&d->bottom, b);
+    cpu_dfence();
+    long top = atomic_load_uncached(&d->top);
+
+    if (top > b) {
+        //  Empty deque
+        atomic_store_uncached(&d->bottom, b + 1);
+        return NULL;
+    }
+
+    task_t *t = (task_t*)atomic_load_uncached(&d->buf[b & TASK_DEQUE_MASK]);
+    if (top == b) {
+        //  Last element: race against thieves
+        if (!atomic_compare_exchange_strong(&d->top, &top, top + 1)) t = NULL;
+        atomic_store_uncached(&d->bottom, b + 1);
+    }
+    return t;
+}
+
+static task_t* __task_deque_steal(task_deque_t *d)
+{
+    long top = atomic_load_uncached(&d->top);
+    cpu_dfence();
+    long b = atomic_load_uncached(&d->bottom);
+    if (top >= b) return NULL;
+
+    task_t *t = (task_t*)atomic_load_uncached(&d->buf[top & TASK_DEQUE_MASK]);
+    if (!atomic_compare_exchange_strong(&d->top, &top, top + 1)) return NULL;
+    return t;
+}
+
+static inline uint32_t __task_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void __task_execute(task_t *t)
+{
+    //  If there is no hardware cache coherency, make sure that the task
+    //  descriptor (written by the spawning CPU) is not cached
+    cpu_dcache_invalidate_range((uintptr_t)t, sizeof(task_t));
+
+    task_group_t *g = t->group;
+    t->func(t->args);
+
+    //  Make sure that results are visible before signaling the completion
+    cpu_dfence();
+    atomic_fetch_sub(&g->pending, 1);
+}
+
+//
+//  Try to get a task: first from the own deque, then from a random victim
+//
+static task_t* __task_get(int sid, uint32_t *rng)
+{
+    task_t *t = __task_deque_take(&__task_deque[sid]);
+    if (t != NULL) return t;
+
+#if BSP_CONFIG_NCPUS > 1
+    int victim = __task_rand(rng) % (BSP_CONFIG_NCPUS - 1);
+    if (victim >= sid) victim++;
+    t = __task_deque_steal(&__task_deque[victim]);
+#endif
+    return t;
+}
+
+static int __task_worker(void *args)
+{
+    int sid = mp_get_self_sid();
+    uint32_t rng = (uint32_t)cpu_cycles() | 1;
+
+    (void)args;
+    while (!atomic_load_uncached(&__task_stop)) {
+        task_t *t = __task_get(sid, &rng);
+        if (t != NULL) __task_execute(t);
+        else           cpu_delay(TASK_IDLE_DELAY);
+    }
+    return THREAD_SUCCESS;
+}
+
+int task_runtime_init(int flags)
+{
+    atomic_store_uncached(&__task_stop, 0);
+    cpu_dfence();
+
+    if (thread_pool_init(&__task_pool, -1, flags) != 0) return -1;
+    return thread_pool_submit_all(&__task_pool, __task_worker, NULL);
+}
+
+int task_runtime_fini()
+{
+    atomic_store_uncached(&__task_stop, 1);
+    cpu_dfence();
+
+    thread_pool_wait_all(&__task_pool);
+    return thread_pool_destroy(&__task_pool);
+}
+
+void task_group_init(task_group_t *g)
+{
+    atomic_store_uncached(&g->pending, 0);
+}
+
+void task_spawn(task_group_t *g, task_t *t, task_func_t func, void *args)
+{
+    t->func  = func;
+    t->args  = args;
+    t->group = g;
+    atomic_fetch_add(&g->pending, 1);
+
+    //  Make sure that the task descriptor is visible before publishing it
+    cpu_dfence();
+
+    if (__task_deque_push(&__task_deque[mp_get_self_sid()], t) != 0) {
+        //  The deque is full: execute the task immediately
+        __task_execute(t);
+    }
+}
+
+void task_sync(task_group_t *g)
+{
+    int sid = mp_get_self_sid();
+    uint32_t rng = (uint32_t)cpu_cycles() | 1;
+
+    while (atomic_load_uncached(&g->pending) > 0) {
+        task_t *t = __task_get(sid, &rng);
+        if (t != NULL) __task_execute(t);
+        else           cpu_delay(TASK_IDLE_DELAY);
+    }
+}
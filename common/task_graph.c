@@ -0,0 +1,241 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/task_graph.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to execute
+ *          graphs of tasks with static dependencies
+ */
+#include <stddef.h>
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/task_graph.h"
+
+#if (TASK_GRAPH_QUEUE_SIZE & (TASK_GRAPH_QUEUE_SIZE - 1)) != 0
+#error "TASK_GRAPH_QUEUE_SIZE shall be a power of 2"
+#endif
+
+#define TASK_GRAPH_IDLE_DELAY 100
+
+static void __task_graph_push(task_graph_t *g, task_graph_node_t *n, int rank);
+
+static void __task_graph_execute(task_graph_t *g, task_graph_node_t *n,
+        int rank)
+{
+    //  If there is no hardware cache coherency, make sure that the node
+    //  descriptor (written by the director thread) is not cached
+    cpu_dcache_invalidate_range((uintptr_t)n, sizeof(task_graph_node_t));
+
+    n->func(n->args);
+
+    //  Make sure that results are visible before releasing the successors
+    cpu_dfence();
+    for (int e = n->first_edge; e >= 0; e = g->edge[e].next) {
+        task_graph_node_t *s = &g->node[g->edge[e].to];
+        if (atomic_fetch_sub(&s->pending, 1) == 1) __task_graph_push(g, s, rank);
+    }
+    atomic_fetch_sub(&g->remaining, 1);
+}
+
+//
+//  Push a ready node to the queue of the given rank. When it is full, try
+//  the queues of the other ranks, and finally execute the node immediately.
+//
+static void __task_graph_push(task_graph_t *g, task_graph_node_t *n, int rank)
+{
+    for (int i = 0; i < g->nranks; i++) {
+        int r = (rank + i) % g->nranks;
+        if (mpmc_ring_push(&g->queue[r], n) == 0) return;
+    }
+    __task_graph_execute(g, n, rank);
+}
+
+//
+//  Try to get a ready node: first from the own queue, then from the queues
+//  of the other ranks
+//
+static task_graph_node_t* __task_graph_get(task_graph_t *g, int rank)
+{
+    void *n;
+    for (int i = 0; i < g->nranks; i++) {
+        int r = (rank + i) % g->nranks;
+        if (mpmc_ring_pop(&g->queue[r], &n) == 0) return n;
+    }
+    return NULL;
+}
+
+static void __task_graph_loop(task_graph_t *g, int rank)
+{
+    while (atomic_load_uncached(&g->remaining) > 0) {
+        task_graph_node_t *n = __task_graph_get(g, rank);
+        if (n != NULL) __task_graph_execute(g, n, rank);
+        else           cpu_delay(TASK_GRAPH_IDLE_DELAY);
+    }
+}
+
+static int __task_graph_worker(void *args)
+{
+    //  If there is no hardware cache coherency, make sure that the graph
+    //  descriptors (written by the director thread) are not cached
+    cpu_dcache_invalidate_range((uintptr_t)args, sizeof(task_graph_rank_t));
+
+    task_graph_rank_t *r = (task_graph_rank_t*)args;
+    task_graph_t *g = r->graph;
+    cpu_dcache_invalidate_range((uintptr_t)g, offsetof(task_graph_t, remaining));
+    cpu_dcache_invalidate_range((uintptr_t)g->edge,
+            g->nedges*sizeof(task_graph_edge_t));
+
+    __task_graph_loop(g, r->rank);
+    return THREAD_SUCCESS;
+}
+
+//
+//  Check that the graph is acyclic (Kahn's algorithm). Nodes whose remaining
+//  predecessors reach zero are kept in a stack linked through the nodes.
+//
+static int __task_graph_check(task_graph_t *g)
+{
+    int top = -1;
+    int visited = 0;
+
+    for (int i = 0; i < g->nnodes; i++) {
+        task_graph_node_t *n = &g->node[i];
+        atomic_store_uncached(&n->pending, n->npreds);
+        if (n->npreds == 0) {
+            n->link = top;
+            top = i;
+        }
+    }
+
+    while (top >= 0) {
+        task_graph_node_t *n = &g->node[top];
+        top = n->link;
+        visited++;
+
+        for (int e = n->first_edge; e >= 0; e = g->edge[e].next) {
+            int to = g->edge[e].to;
+            if (atomic_fetch_sub(&g->node[to].pending, 1) == 1) {
+                g->node[to].link = top;
+                top = to;
+            }
+        }
+    }
+
+    return (visited == g->nnodes) ? 0 : -1;
+}
+
+int task_graph_init(task_graph_t *g, task_graph_node_t *node, int max_nodes,
+        task_graph_edge_t *edge, int max_edges)
+{
+    if ((node == NULL) || (max_nodes <= 0)) return -1;
+    if ((edge == NULL) && (max_edges > 0)) return -1;
+
+    g->node      = node;
+    g->max_nodes = max_nodes;
+    g->edge      = edge;
+    g->max_edges = max_edges;
+    g->nranks    = 1;
+    task_graph_reset(g);
+
+    for (int i = 0; i < BSP_CONFIG_NCPUS; i++) {
+        g->rank[i].graph = g;
+        g->rank[i].rank  = i;
+        mpmc_ring_init(&g->queue[i], g->cell[i], TASK_GRAPH_QUEUE_SIZE);
+    }
+    return 0;
+}
+
+void task_graph_reset(task_graph_t *g)
+{
+    g->nnodes  = 0;
+    g->nedges  = 0;
+    g->checked = 0;
+}
+
+int task_graph_add_node(task_graph_t *g, task_graph_func_t func, void *args)
+{
+    if ((func == NULL) || (g->nnodes >= g->max_nodes)) return -1;
+
+    int id = g->nnodes++;
+    task_graph_node_t *n = &g->node[id];
+    n->func       = func;
+    n->args       = args;
+    n->npreds     = 0;
+    n->first_edge = -1;
+    return id;
+}
+
+int task_graph_add_edge(task_graph_t *g, int from, int to)
+{
+    if ((from < 0) || (from >= g->nnodes)) return -1;
+    if ((to < 0) || (to >= g->nnodes)) return -1;
+    if (g->nedges >= g->max_edges) return -1;
+
+    int id = g->nedges++;
+    g->edge[id].to   = to;
+    g->edge[id].next = g->node[from].first_edge;
+    g->node[from].first_edge = id;
+    g->node[to].npreds++;
+    g->checked = 0;
+    return 0;
+}
+
+int task_graph_run(task_graph_t *g, thread_pool_t *pool)
+{
+    if (g->nnodes == 0) return 0;
+    if (!g->checked) {
+        if (__task_graph_check(g) != 0) return -1;
+        g->checked = 1;
+    }
+
+    int nworkers = (pool != NULL) ? thread_pool_size(pool) : 0;
+    if (nworkers > BSP_CONFIG_NCPUS - 1) nworkers = BSP_CONFIG_NCPUS - 1;
+    if (nworkers > g->nnodes - 1) nworkers = g->nnodes - 1;
+    g->nranks = nworkers + 1;
+
+    //  Reset the predecessor counters. Queues are empty after the previous
+    //  execution.
+    for (int i = 0; i < g->nnodes; i++) {
+        atomic_store_uncached(&g->node[i].pending, g->node[i].npreds);
+    }
+    atomic_store_uncached(&g->remaining, g->nnodes);
+
+    //  Distribute the nodes with no predecessors among the participants
+    for (int i = 0, r = 0; i < g->nnodes; i++) {
+        if (g->node[i].npreds != 0) continue;
+        if (mpmc_ring_push(&g->queue[r], &g->node[i]) != 0) {
+            __task_graph_push(g, &g->node[i], r);
+        }
+        r = (r + 1) % g->nranks;
+    }
+
+    //  Make sure that the graph descriptors are visible
+    cpu_dfence();
+
+    for (int i = 0; i < nworkers; i++) {
+        thread_pool_submit(pool, i, __task_graph_worker, &g->rank[i + 1]);
+    }
+
+    //  The calling CPU participates as rank 0
+    __task_graph_loop(g, 0);
+
+    int ret = 0;
+    for (int i = 0; i < nworkers; i++) {
+        if (thread_pool_wait(pool, i) != THREAD_SUCCESS) ret = -1;
+    }
+    return ret;
+}
@@ -0,0 +1,193 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/thread_pool.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          a pool of persistent worker threads
+ */
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/mp.h"
+#include "common/threads.h"
+#include "common/thread_pool.h"
+
+#define THREAD_POOL_POLL_DELAY 100
+
+//
+//  Dispatch loop executed by the worker threads
+//
+//  The worker waits for the dispatch sequence number to change, then executes
+//  the corresponding work item and publishes its completion. A NULL work
+//  function requests the worker to exit.
+//
+static int __thread_pool_worker(void *args)
+{
+    thread_pool_worker_t *w = (thread_pool_worker_t*)args;
+    unsigned int last = 0;
+
+    for (;;) {
+        unsigned int seq;
+        while ((seq = atomic_load_uncached(&w->seq)) == last) {
+            if (w->flags & THREAD_POOL_WFI) mp_wait_for_wakeup();
+            else                            cpu_delay(THREAD_POOL_POLL_DELAY);
+        }
+        last = seq;
+
+        cpu_entry_func_t func =
+            (cpu_entry_func_t)atomic_load_uncached(&w->func);
+        void *func_args = (void*)atomic_load_uncached(&w->args);
+
+        //  Exit request
+        if (func == NULL) {
+            cpu_dfence();
+            atomic_store_uncached(&w->done, seq);
+            return THREAD_SUCCESS;
+        }
+
+        int status = func(func_args);
+
+        //  Make sure that the results of the work item are visible before
+        //  signaling its completion
+        cpu_dfence();
+        atomic_store_uncached(&w->status, status);
+        atomic_store_uncached(&w->done, seq);
+    }
+}
+
+static void __thread_pool_dispatch(thread_pool_worker_t *w,
+        cpu_entry_func_t func, void *args)
+{
+    w->next++;
+    atomic_store_uncached(&w->func, (uintptr_t)func);
+    atomic_store_uncached(&w->args, (uintptr_t)args);
+
+    //  Make sure that the work item is visible before publishing it
+    cpu_dfence();
+    atomic_store_uncached(&w->seq, w->next);
+
+    if (w->flags & THREAD_POOL_WFI) mp_wakeup_cpu(w->cpu_id);
+}
+
+static void __thread_pool_wait(thread_pool_worker_t *w)
+{
+    while (atomic_load_uncached(&w->done) != w->next) {
+        cpu_delay(THREAD_POOL_POLL_DELAY);
+    }
+}
+
+int thread_pool_init(thread_pool_t *pool, int nworkers, int flags)
+{
+    if (nworkers < 0) nworkers = mp_get_cpu_count() - 1;
+    if (nworkers > mp_get_cpu_count() - 1) return -1;
+
+    pool->nworkers = 0;
+    pool->flags    = flags;
+
+    for (int i = 0; i < nworkers; i++) {
+        thread_pool_worker_t *w = &pool->worker[i];
+
+        atomic_store_uncached(&w->seq, 0);
+        atomic_store_uncached(&w->done, 0);
+        atomic_store_uncached(&w->func, (uintptr_t)NULL);
+        atomic_store_uncached(&w->args, (uintptr_t)NULL);
+        atomic_store_uncached(&w->status, THREAD_SUCCESS);
+        w->next  = 0;
+        w->flags = flags;
+        thread_init(&w->thread);
+        if (flags & THREAD_POOL_WFI) w->thread.flags = THREAD_JOIN_WFI;
+
+        //  Make sure that the worker descriptor is visible
+        cpu_dfence();
+
+        if (thread_create(&w->thread, __thread_pool_worker, w) != 0) {
+            thread_pool_destroy(pool);
+            return -1;
+        }
+
+        w->cpu_id = w->thread.id;
+        pool->nworkers++;
+    }
+
+    return 0;
+}
+
+int thread_pool_destroy(thread_pool_t *pool)
+{
+    int ret = 0;
+
+    for (int i = 0; i < pool->nworkers; i++) {
+        thread_pool_worker_t *w = &pool->worker[i];
+        __thread_pool_wait(w);
+        __thread_pool_dispatch(w, NULL, NULL);
+    }
+
+    for (int i = 0; i < pool->nworkers; i++) {
+        if (thread_join(&pool->worker[i].thread) != 0) ret = -1;
+    }
+
+    pool->nworkers = 0;
+    return ret;
+}
+
+int thread_pool_submit(thread_pool_t *pool, int worker,
+        cpu_entry_func_t func, void *args)
+{
+    if ((worker < 0) || (worker >= pool->nworkers)) return -1;
+    if (func == NULL) return -1;
+
+    thread_pool_worker_t *w = &pool->worker[worker];
+    __thread_pool_wait(w);
+    __thread_pool_dispatch(w, func, args);
+    return 0;
+}
+
+int thread_pool_submit_all(thread_pool_t *pool,
+        cpu_entry_func_t func, void *args)
+{
+    for (int i = 0; i < pool->nworkers; i++) {
+        if (thread_pool_submit(pool, i, func, args) != 0) return -1;
+    }
+    return 0;
+}
+
+int thread_pool_is_done(thread_pool_t *pool, int worker)
+{
+    if ((worker < 0) || (worker >= pool->nworkers)) return -1;
+
+    thread_pool_worker_t *w = &pool->worker[worker];
+    return (atomic_load_uncached(&w->done) == w->next);
+}
+
+int thread_pool_wait(thread_pool_t *pool, int worker)
+{
+    if ((worker < 0) || (worker >= pool->nworkers)) return THREAD_FAILURE;
+
+    thread_pool_worker_t *w = &pool->worker[worker];
+    __thread_pool_wait(w);
+    return atomic_load_uncached(&w->status);
+}
+
+int thread_pool_wait_all(thread_pool_t *pool)
+{
+    int ret = THREAD_SUCCESS;
+
+    for (int i = 0; i < pool->nworkers; i++) {
+        if (thread_pool_wait(pool, i) == THREAD_FAILURE) ret = THREAD_FAILURE;
+    }
+    return ret;
+}
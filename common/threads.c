@@ -24,59 +24,157 @@
 #include "common/mp.h"
 #include "common/cache.h"
 #include "common/threads.h"
+#include "common/backoff.h"
 #include "drivers/clint.h"
 
+#ifndef THREAD_JOIN_BACKOFF_MIN
+#define THREAD_JOIN_BACKOFF_MIN 16
+#endif
+#ifndef THREAD_JOIN_BACKOFF_MAX
+#define THREAD_JOIN_BACKOFF_MAX 1024
+#endif
+
+//
+//  Value of the completion word once the entry function returned. Before,
+//  it is 0, or the logical ID + 1 of the CPU waiting in thread_join with
+//  THREAD_JOIN_WFI.
+//
+#define THREAD_EXITED (-1)
+
+void thread_init(thread_t *t)
+{
+    t->id        = 0;
+    t->cpu_id    = NULL;
+    t->desc      = NULL;
+    t->ret       = NULL;
+    t->placement = MP_PLACE_FIRST;
+    t->flags     = 0;
+    t->init      = THREAD_INIT_MAGIC;
+    cpuset_zero(&t->cpuset);
+    atomic_store_uncached(&t->done, 0);
+}
+
 int thread_create(thread_t *t, cpu_entry_func_t func, void *args)
 {
-    //  Get description of the target CPU
-    volatile cpu_t* cpu;
-    if (t->cpu_id != NULL) cpu = cpu_get_desc((uintptr_t)t->cpu_id);
-    else                   cpu = mp_get_free_cpu();
+    return thread_create_group(t, 1, func, &args);
+}
 
-    //  No valid CPU
-    if (cpu == NULL) return -1;
+//
+//  Aborts the creation of a group of threads: the creation requests are
+//  withdrawn. Target CPUs that did not handle the IPI yet ignore it, and the
+//  ones already AWAKE go back to IDLE (see bsp_secondary_start).
+//
+static void __thread_create_abort(volatile cpu_t **cpu, int n)
+{
+    for (int i = 0; i < n; i++) cpu_set_ipi_kind(cpu[i]->sid, CPU_IPI_NULL);
+    cpu_dfence();
+}
 
-    //  If there is no hardware cache coherency, make sure that the CPU
-    //  description structure is not cached. This way the following accesses
-    //  will fetch up to date data.
-    cpu_dcache_invalidate_range((uintptr_t)cpu, sizeof(cpu_t));
+int thread_create_group(thread_t *t, int n, cpu_entry_func_t func,
+        void * const *args)
+{
+    volatile cpu_t* cpu[BSP_CONFIG_NCPUS];
+    cpuset_t used;
+
+    if ((n <= 0) || (n > BSP_CONFIG_NCPUS)) return -1;
+    cpuset_zero(&used);
+
+    //  Get description of the target CPUs. CPUs already selected for a
+    //  previous thread of the group are excluded.
+    for (int i = 0; i < n; i++) {
+        //  Structures not initialized by thread_init only provide cpu_id
+        int init = (t[i].init == THREAD_INIT_MAGIC);
+        if (!init) t[i].flags = 0;
+
+        if (t[i].cpu_id != NULL) {
+            cpu[i] = cpu_get_desc((uintptr_t)t[i].cpu_id);
+        } else {
+            cpuset_t set;
+            if (init) set = t[i].cpuset;
+            else      cpuset_zero(&set);
+            if (cpuset_isempty(&set)) cpuset_fill(&set);
+            cpuset_andnot(&set, &used);
 
-    //  Check that the target core is actually IDLE
-    if (cpu_get_state(cpu->sid) != CPU_IDLE) return -1;
+            cpu[i] = NULL;
+            if (!cpuset_isempty(&set)) {
+                cpu[i] = mp_get_free_cpu_in(&set,
+                        init ? t[i].placement : MP_PLACE_FIRST);
+            }
+        }
 
-    //  Write arguments for the new thread
-    cpu->entry_func = func;
-    cpu->args       = args;
-    cpu->ipi_kind   = CPU_IPI_CREATE;
-    cpu->thread     = t;
+        //  No valid CPU
+        if (cpu[i] == NULL) return -1;
+
+        //  If there is no hardware cache coherency, make sure that the CPU
+        //  description structure is not cached. This way the following
+        //  accesses will fetch up to date data.
+        cpu_dcache_invalidate_range((uintptr_t)cpu[i], sizeof(cpu_t));
+
+        //  Check that the target core is actually IDLE, and not selected
+        //  twice
+        if (cpu_get_state(cpu[i]->sid) != CPU_IDLE) return -1;
+        if (cpuset_isset(&used, cpu[i]->sid)) return -1;
+        cpuset_set(&used, cpu[i]->sid);
+    }
+
+    //  Write arguments for the new threads
+    for (int i = 0; i < n; i++) {
+        cpu[i]->entry_func = func;
+        cpu[i]->args       = (args != NULL) ? args[i] : NULL;
+        cpu[i]->ipi_kind   = CPU_IPI_CREATE;
+        cpu[i]->thread     = &t[i];
+
+        //  Reset the completion word of the thread
+        atomic_store_uncached(&t[i].done, 0);
+    }
 
     //  Make sure that arguments are visible
     cpu_dfence();
 
-    //  Send an IPI to the target core
-    clint_send_ipi(cpu->clint_drv, cpu->hid);
+    //  Send the IPIs back-to-back. Consecutive target cores sharing the same
+    //  clint are signaled in a single call.
+    for (int i = 0; i < n;) {
+        clint_drv_t *drv = cpu[i]->clint_drv;
+        int hid[BSP_CONFIG_NCPUS];
+        int m = 0;
+        for (; (i < n) && (cpu[i]->clint_drv == drv); i++) {
+            hid[m++] = cpu[i]->hid;
+        }
+        clint_send_ipi_multi(drv, hid, m);
+    }
 
-    //  Wait for the target core to be AWAKE
-    int timeout = 1;
-    for (int i = 0; (i < 10000) && timeout; i++) {
+    //  Wait for all the target cores to be AWAKE
+    int pending = n;
+    for (int i = 0; (i < 10000) && pending; i++) {
         cpu_delay(1000);
 
-        enum cpu_state_e state = cpu_get_state(cpu->sid);
-        if (state == CPU_AWAKE) timeout = 0;
-        if (state == CPU_ERROR) return -1;
+        pending = 0;
+        for (int k = 0; k < n; k++) {
+            enum cpu_state_e state = cpu_get_state(cpu[k]->sid);
+            if (state == CPU_ERROR) {
+                __thread_create_abort(cpu, n);
+                return -1;
+            }
+            if (state != CPU_AWAKE) pending++;
+        }
     }
 
-    //  The target thread did not wake up (in reasonable time)
-    if (timeout) return -2;
+    //  Some target threads did not wake up (in reasonable time)
+    if (pending) {
+        __thread_create_abort(cpu, n);
+        return -2;
+    }
 
-    //  Fill the thread structure on successfull creation
-    t->id     = cpu->sid;
-    t->cpu_id = (void*)((uintptr_t)cpu->sid);
-    t->desc   = (cpu_t*)cpu;
-    t->ret    = NULL;
+    //  Fill the thread structures on successfull creation
+    for (int i = 0; i < n; i++) {
+        t[i].id     = cpu[i]->sid;
+        t[i].cpu_id = (void*)((uintptr_t)cpu[i]->sid);
+        t[i].desc   = (cpu_t*)cpu[i];
+        t[i].ret    = NULL;
+    }
 
-    //  Declare the target thread as running
-    cpu_set_state(cpu->sid, CPU_RUNNING);
+    //  Declare the target threads as running
+    for (int i = 0; i < n; i++) cpu_set_state(cpu[i]->sid, CPU_RUNNING);
     return 0;
 }
 
@@ -102,12 +200,6 @@ int thread_destroy(thread_t *t)
     //  Send an IPI to the target core
     clint_send_ipi(t->desc->clint_drv, t->desc->hid);
 
-    //  Wait for the target core to be IDLE
-    return thread_join(t);
-}
-
-int thread_join(thread_t *t)
-{
     //  Wait for the target core to be IDLE (or ERROR)
     for (int timeout = 0; timeout < 10000; timeout++) {
         enum cpu_state_e state = cpu_get_state(t->desc->sid);
@@ -118,10 +210,50 @@ int thread_join(thread_t *t)
     return -2;
 }
 
+int thread_join(thread_t *t)
+{
+    if (t->flags & THREAD_JOIN_WFI) {
+        //  Declare this CPU as the joiner in the completion word, unless the
+        //  thread already exited. The thread swaps the completion word when
+        //  exiting. Thus, either the joiner sees the completion, or the
+        //  thread sees the joiner and sends it an IPI.
+        int running = 0;
+        if (atomic_compare_exchange_strong(&t->done, &running,
+                    mp_get_self_sid() + 1)) {
+            while (atomic_load_uncached(&t->done) != THREAD_EXITED) {
+                mp_wait_for_wakeup();
+            }
+        }
+    } else {
+        backoff_t b;
+        backoff_init(&b, THREAD_JOIN_BACKOFF_MIN, THREAD_JOIN_BACKOFF_MAX);
+        while (atomic_load_uncached(&t->done) != THREAD_EXITED) {
+            backoff_exponential(&b);
+        }
+    }
+
+    t->ret = (void*)atomic_load_uncached((atomic_uintptr_t*)&t->ret);
+    return ((intptr_t)t->ret == THREAD_FAILURE) ? -1 : 0;
+}
+
+void thread_signal_exit(thread_t *t, int status)
+{
+    atomic_store_uncached((atomic_uintptr_t*)&t->ret, (uintptr_t)(intptr_t)status);
+
+    //  Make sure that the results of the thread are visible before signaling
+    //  its completion
+    cpu_dfence();
+
+    //  The thread structure may be released by the joiner as soon as the
+    //  completion is visible: it shall not be accessed afterwards
+    int joiner = atomic_store_uncached(&t->done, THREAD_EXITED);
+    if (joiner > 0) mp_wakeup_cpu(joiner - 1);
+}
+
 int thread_id()
 {
     //  Get thread description structure
-    cpu_t *cpu = (cpu_t*)cpu_get_thread_pointer();
+    cpu_t *cpu = mp_get_self_desc();
     if (cpu == NULL) return -1;
 
     //  If there is no hardware cache coherency, make sure that the CPU
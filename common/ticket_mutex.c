@@ -22,9 +22,19 @@
  *          mutexes (mutual exclusion locks)
  */
 #include "common/ticket_mutex.h"
+#include "common/backoff.h"
 #include "common/cpu.h"
 
-#define MUTEX_WAIT_DELAY 500
+//
+//  Backoff parameters (in cycles). Waiters poll with a delay proportional to
+//  the number of tickets ahead of them, capped to a maximum.
+//
+#ifndef TICKET_MUTEX_BACKOFF_UNIT
+#define TICKET_MUTEX_BACKOFF_UNIT 100
+#endif
+#ifndef TICKET_MUTEX_BACKOFF_MAX
+#define TICKET_MUTEX_BACKOFF_MAX 4000
+#endif
 
 void ticket_mutex_init(ticket_mutex_t *m)
 {
@@ -40,15 +50,23 @@ void ticket_mutex_lock(ticket_mutex_t *m)
 {
     cpu_dfence();
     int ticket = atomic_fetch_add(&m->next, 1);
-    while(ticket != atomic_fetch_or(&m->curr, 0)) {
-        cpu_delay(MUTEX_WAIT_DELAY);
+    for (;;) {
+        int distance = ticket - atomic_fetch_or(&m->curr, 0);
+        if (distance == 0) break;
+        backoff_proportional(distance, TICKET_MUTEX_BACKOFF_UNIT,
+                TICKET_MUTEX_BACKOFF_MAX);
     }
 }
 
 int ticket_mutex_trylock(ticket_mutex_t *m)
 {
-    ticket_mutex_lock(m);
-    return 1;
+    cpu_dfence();
+
+    //  The mutex is free when there is no pending ticket. In that case, take
+    //  the next ticket only if nobody took it in the meantime.
+    int curr = atomic_fetch_or(&m->curr, 0);
+    int next = curr;
+    return atomic_compare_exchange_strong(&m->next, &next, curr + 1);
 }
 
 void ticket_mutex_unlock(ticket_mutex_t *m)
@@ -0,0 +1,87 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/tls.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines used to manage the thread-local
+ *          storage (TLS) of the CPUs
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bsp/bsp_config.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/tls.h"
+
+//
+//  TLS template (see linkcmds.include)
+//
+extern char _stls[];
+extern char _etdata[];
+extern char _etls[];
+extern char _tls_align[];
+
+static uintptr_t __tls_base;
+static size_t __tls_stride;
+
+size_t tls_get_size()
+{
+    return (uintptr_t)_etls - (uintptr_t)_stls;
+}
+
+int tls_init()
+{
+    size_t align = (uintptr_t)_tls_align;
+    if (align < BSP_CONFIG_DCACHE_LINE_BYTES) {
+        align = BSP_CONFIG_DCACHE_LINE_BYTES;
+    }
+
+    //  No thread-local variables
+    size_t stride = (tls_get_size() + align - 1) & ~(align - 1);
+    if (stride == 0) return 0;
+
+    void *p = malloc(stride*BSP_CONFIG_NCPUS + align - 1);
+    if (p == NULL) return -1;
+
+    __tls_base   = ((uintptr_t)p + align - 1) & ~(align - 1);
+    __tls_stride = stride;
+
+    //  Make sure that the TLS descriptors are visible
+    cpu_dfence();
+    return 0;
+}
+
+void* tls_get_block(int cpu_id)
+{
+    if ((__tls_stride == 0) || (cpu_id < 0) || (cpu_id >= BSP_CONFIG_NCPUS)) {
+        return NULL;
+    }
+    return (void*)(__tls_base + cpu_id*__tls_stride);
+}
+
+void tls_enter(int cpu_id)
+{
+    char *block = (char*)tls_get_block(cpu_id);
+    if (block == NULL) return;
+
+    size_t tdata_bytes = (uintptr_t)_etdata - (uintptr_t)_stls;
+    memcpy(block, _stls, tdata_bytes);
+    memset(block + tdata_bytes, 0, tls_get_size() - tdata_bytes);
+
+    cpu_set_thread_pointer((uintptr_t)block);
+}
@@ -21,51 +21,70 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdatomic.h>
+#include "common/cache.h"
 #include "common/cpu.h"
+#include "common/mp.h"
+#include "common/percpu.h"
 #include "common/trap_handler.h"
 #include "bsp/bsp_config.h"
 
-static irq_handler_t __per_core_irq_ipi_handler[BSP_CONFIG_NCPUS];
-static irq_handler_t __per_core_irq_tim_handler[BSP_CONFIG_NCPUS];
-static irq_handler_t __per_core_irq_ext_handler[BSP_CONFIG_NCPUS];
-static exc_handler_t __per_core_exc_ld_flt_handler[BSP_CONFIG_NCPUS];
-static exc_handler_t __per_core_exc_st_flt_handler[BSP_CONFIG_NCPUS];
-static exc_handler_t __per_core_exc_flt_handler[BSP_CONFIG_NCPUS];
+typedef struct trap_handlers_s
+{
+    irq_handler_t irq_ipi;
+    irq_handler_t irq_tim;
+    irq_handler_t irq_ext;
+    exc_handler_t exc_ld_flt;
+    exc_handler_t exc_st_flt;
+    exc_handler_t exc_flt;
+} trap_handlers_t;
+
+static DEFINE_PER_CPU(trap_handlers_t, __trap_handlers);
+
+//
+//  Handlers may be set by other CPUs
+//
+#define __trap_load(p) \
+    ((__typeof__(*(p)))atomic_load_uncached((atomic_uintptr_t*)(p)))
+#define __trap_store(p, v) \
+    atomic_store_uncached((atomic_uintptr_t*)(p), (uintptr_t)(v))
+
+//
+//  Handlers of the given core (physical ID)
+//
+static inline trap_handlers_t* __trap_handlers_of(int core)
+{
+    return per_cpu_ptr(__trap_handlers, cpu_hid2sid[core]);
+}
 
 void set_irq_ipi_handler(int core, irq_handler_t handler)
 {
-    __per_core_irq_ipi_handler[core] = handler;
-    cpu_dfence();
+    __trap_store(&__trap_handlers_of(core)->irq_ipi, handler);
 }
 
 void set_irq_tim_handler(int core, irq_handler_t handler)
 {
-    __per_core_irq_tim_handler[core] = handler;
-    cpu_dfence();
+    __trap_store(&__trap_handlers_of(core)->irq_tim, handler);
 }
 
 void set_irq_ext_handler(int core, irq_handler_t handler)
 {
-    __per_core_irq_ext_handler[core] = handler;
-    cpu_dfence();
+    __trap_store(&__trap_handlers_of(core)->irq_ext, handler);
 }
 
 void set_exc_ld_flt_handler(int core, exc_handler_t handler)
 {
-    __per_core_exc_ld_flt_handler[core] = handler;
-    cpu_dfence();
+    __trap_store(&__trap_handlers_of(core)->exc_ld_flt, handler);
 }
 
 void set_exc_st_flt_handler(int core, exc_handler_t handler)
 {
-    __per_core_exc_st_flt_handler[core] = handler;
-    cpu_dfence();
+    __trap_store(&__trap_handlers_of(core)->exc_st_flt, handler);
 }
 
 void set_exc_flt_handler(int core, exc_handler_t handler)
 {
-    __per_core_exc_flt_handler[core] = handler;
-    cpu_dfence();
+    __trap_store(&__trap_handlers_of(core)->exc_flt, handler);
 }
 
 static void __irq_handler(uintptr_t mcause, uintptr_t mstatus, uintptr_t mepc)
@@ -73,7 +92,7 @@ static void __irq_handler(uintptr_t mcause, uintptr_t mstatus, uintptr_t mepc)
     irq_handler_t handler;
     switch (mcause) {
         case MCAUSE_M_SOFTWARE_INTERRUPT:
-            handler = __per_core_irq_ipi_handler[cpu_id()];
+            handler = __trap_load(&__trap_handlers_of(cpu_id())->irq_ipi);
             if (handler) {
                 handler(mcause, mstatus, mepc);
                 break;
@@ -82,7 +101,7 @@ static void __irq_handler(uintptr_t mcause, uintptr_t mstatus, uintptr_t mepc)
             exit(EXIT_FAILURE);
 
         case MCAUSE_M_TIMER_INTERRUPT:
-            handler = __per_core_irq_tim_handler[cpu_id()];
+            handler = __trap_load(&__trap_handlers_of(cpu_id())->irq_tim);
             if (handler) {
                 handler(mcause, mstatus, mepc);
                 break;
@@ -91,7 +110,7 @@ static void __irq_handler(uintptr_t mcause, uintptr_t mstatus, uintptr_t mepc)
             exit(EXIT_FAILURE);
 
         case MCAUSE_M_EXTERNAL_INTERRUPT:
-            handler = __per_core_irq_ext_handler[cpu_id()];
+            handler = __trap_load(&__trap_handlers_of(cpu_id())->irq_ext);
             if (handler) {
                 handler(mcause, mstatus, mepc);
                 break;
@@ -112,7 +131,7 @@ static void __exc_handler(uintptr_t mcause, uintptr_t mstatus, uintptr_t mepc, u
     switch (mcause) {
         case MCAUSE_INSTR_ADDR_MISALIGNED:
         case MCAUSE_INSTR_ACCESS_FAULT:
-            handler = __per_core_exc_flt_handler[cpu_id()];
+            handler = __trap_load(&__trap_handlers_of(cpu_id())->exc_flt);
             if (handler) {
                 handler(mcause, mstatus, mepc, mtval);
                 return;
@@ -121,7 +140,7 @@ static void __exc_handler(uintptr_t mcause, uintptr_t mstatus, uintptr_t mepc, u
             break;
 
         case MCAUSE_INSTR_ILLEGAL:
-            handler = __per_core_exc_flt_handler[cpu_id()];
+            handler = __trap_load(&__trap_handlers_of(cpu_id())->exc_flt);
             if (handler) {
                 handler(mcause, mstatus, mepc, mtval);
                 return;
@@ -131,7 +150,7 @@ static void __exc_handler(uintptr_t mcause, uintptr_t mstatus, uintptr_t mepc, u
 
         case MCAUSE_LOAD_ACCESS_FAULT:
         case MCAUSE_LOAD_ADDR_MISALIGNED:
-            handler = __per_core_exc_ld_flt_handler[cpu_id()];
+            handler = __trap_load(&__trap_handlers_of(cpu_id())->exc_ld_flt);
             if (handler) {
                 handler(mcause, mstatus, mepc, mtval);
                 return;
@@ -141,7 +160,7 @@ static void __exc_handler(uintptr_t mcause, uintptr_t mstatus, uintptr_t mepc, u
 
         case MCAUSE_STORE_ACCESS_FAULT:
         case MCAUSE_STORE_ADDR_MISALIGNED:
-            handler = __per_core_exc_st_flt_handler[cpu_id()];
+            handler = __trap_load(&__trap_handlers_of(cpu_id())->exc_st_flt);
             if (handler) {
                 handler(mcause, mstatus, mepc, mtval);
                 return;
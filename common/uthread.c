@@ -0,0 +1,385 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/uthread.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          user-level threads
+ */
+#include "common/cpu.h"
+#include "common/cpu_context.h"
+#include "common/cpu_defs.h"
+#include "common/mp.h"
+#include "common/percpu.h"
+#include "common/trap_handler.h"
+#include "common/uthread.h"
+#include "drivers/clint.h"
+
+#define UTHREAD_IDLE_DELAY 100
+
+extern void uthread_switch(uintptr_t *prev_sp, uintptr_t next_sp);
+extern void uthread_start();
+extern void uthread_call_preempt(void (*func)(void *), void *args);
+
+static DEFINE_PER_CPU(uthread_sched_t, __uthread_sched);
+
+//
+//  Run queues are private to their CPU. They are also accessed by the timer
+//  interrupt handler when preemption is enabled: interrupts are disabled
+//  while the scheduler state is modified.
+//
+static inline uintptr_t __uthread_irq_save()
+{
+    uintptr_t mstatus = read_csr(mstatus);
+    cpu_disable_interrupts();
+    return mstatus & MSTATUS_MIE;
+}
+
+static inline void __uthread_irq_restore(uintptr_t mie)
+{
+    if (mie) cpu_enable_interrupts();
+}
+
+static inline void __uthread_enqueue(uthread_queue_t *q, uthread_t *t)
+{
+    t->next = NULL;
+    if (q->tail != NULL) q->tail->next = t;
+    else                 q->head = t;
+    q->tail = t;
+}
+
+static inline uthread_t* __uthread_dequeue(uthread_queue_t *q)
+{
+    uthread_t *t = q->head;
+    if (t == NULL) return NULL;
+
+    q->head = t->next;
+    if (q->head == NULL) q->tail = NULL;
+    return t;
+}
+
+static void __uthread_remove(uthread_queue_t *q, uthread_t *t)
+{
+    uthread_t *prev = NULL;
+    for (uthread_t *i = q->head; i != NULL; prev = i, i = i->next) {
+        if (i != t) continue;
+
+        if (prev != NULL) prev->next = t->next;
+        else              q->head = t->next;
+        if (q->tail == t) q->tail = prev;
+        t->next = NULL;
+        return;
+    }
+}
+
+static uthread_sched_t* __uthread_get_sched()
+{
+    uthread_sched_t *s = this_cpu_ptr(__uthread_sched);
+    if (!s->initialized) {
+        for (int p = 0; p < UTHREAD_NPRIO; p++) {
+            s->ready[p].head = s->ready[p].tail = NULL;
+        }
+        s->sleeping.head = s->sleeping.tail = NULL;
+        s->main.state    = UTHREAD_RUNNING;
+        s->main.prio     = 0;
+        s->main.next     = NULL;
+        s->current       = &s->main;
+        s->preempt       = 0;
+        s->saved_mie     = 0;
+        s->initialized   = 1;
+    }
+    return s;
+}
+
+//
+//  Move the sleeping threads whose wake-up time has passed to the run queue
+//
+static void __uthread_wakeup_sleepers(uthread_sched_t *s)
+{
+    if (s->sleeping.head == NULL) return;
+
+    uint64_t now = cpu_cycles();
+    uthread_queue_t still = { NULL, NULL };
+    uthread_t *t;
+
+    while ((t = __uthread_dequeue(&s->sleeping)) != NULL) {
+        if (now >= t->wakeup) {
+            t->state = UTHREAD_READY;
+            __uthread_enqueue(&s->ready[t->prio], t);
+        } else {
+            __uthread_enqueue(&still, t);
+        }
+    }
+    s->sleeping = still;
+}
+
+//
+//  Get the first ready thread with the highest priority (not lower than the
+//  given one)
+//
+static uthread_t* __uthread_pick(uthread_sched_t *s, int min_prio)
+{
+    for (int p = UTHREAD_NPRIO - 1; p >= min_prio; p--) {
+        uthread_t *t = __uthread_dequeue(&s->ready[p]);
+        if (t != NULL) return t;
+    }
+    return NULL;
+}
+
+static int __uthread_has_ready(uthread_sched_t *s)
+{
+    for (int p = 0; p < UTHREAD_NPRIO; p++) {
+        if (s->ready[p].head != NULL) return 1;
+    }
+    return 0;
+}
+
+//
+//  Program the next tick. In tickless mode, the timer is disarmed when the
+//  running thread is alone.
+//
+static void __uthread_timer_update(uthread_sched_t *s)
+{
+    if (!s->preempt) return;
+
+    clint_drv_t *clint = cpu_list[mp_get_self_sid()].clint_drv;
+    int hid = cpu_id();
+
+    if ((s->flags & UTHREAD_TICKLESS) && !__uthread_has_ready(s) &&
+            (s->sleeping.head == NULL)) {
+        clint_set_mtimecmp(clint, hid, (uintptr_t)-1ULL);
+        return;
+    }
+    clint_set_timer_period(clint, hid, s->period);
+}
+
+//
+//  Select the next thread and switch to it. The caller sets the state of the
+//  current thread beforehand: if it is still RUNNING, it is put back in the
+//  run queue. Interrupts shall be disabled.
+//
+//  When called from the timer interrupt handler, the switch is done within
+//  the trap context. The trap frame remains in the stack of the preempted
+//  thread, and it is restored when this thread is scheduled again.
+//
+static void __uthread_schedule(uthread_sched_t *s)
+{
+    uthread_t *prev = s->current;
+    uthread_t *next;
+
+    for (;;) {
+        __uthread_wakeup_sleepers(s);
+        if (prev->state == UTHREAD_RUNNING) {
+            //  Continue with the current thread if no other thread with the
+            //  same or higher priority is ready
+            next = __uthread_pick(s, prev->prio);
+            if (next == NULL) {
+                __uthread_timer_update(s);
+                return;
+            }
+            break;
+        }
+
+        next = __uthread_pick(s, 0);
+        if (next != NULL) break;
+        cpu_delay(UTHREAD_IDLE_DELAY);
+    }
+
+    if (prev->state == UTHREAD_RUNNING) {
+        prev->state = UTHREAD_READY;
+        __uthread_enqueue(&s->ready[prev->prio], prev);
+    }
+
+    next->state = UTHREAD_RUNNING;
+    s->current  = next;
+    __uthread_timer_update(s);
+    if (next != prev) uthread_switch(&prev->sp, next->sp);
+}
+
+static void __uthread_preempt(void *args)
+{
+    __uthread_schedule((uthread_sched_t*)args);
+}
+
+static void __uthread_tick(uintptr_t mcause, uintptr_t mstatus, uintptr_t mepc)
+{
+    //  Interrupts are disabled within the trap handler. The trap entry only
+    //  saves the integer registers: the floating-point and vector state of
+    //  the preempted thread is saved in its stack around the switch.
+    uthread_call_preempt(__uthread_preempt, __uthread_get_sched());
+}
+
+//
+//  First function executed by a new thread (called by uthread_start, the
+//  return address of its initial switch frame). It is reached with
+//  interrupts disabled, either from a scheduling point or from the timer
+//  interrupt handler. The MIE state of the creator is restored.
+//
+void __uthread_entry(uintptr_t mie)
+{
+    uthread_sched_t *s = __uthread_get_sched();
+    uthread_t *t = s->current;
+
+    if (mie || s->preempt) cpu_enable_interrupts();
+    t->func(t->args);
+    uthread_exit();
+}
+
+int uthread_create(uthread_t *t, uthread_func_t func, void *args,
+        void *stack, size_t stack_bytes)
+{
+    if (stack_bytes < UTHREAD_STACK_MIN) return -1;
+
+    uintptr_t mie = __uthread_irq_save();
+
+    //  Build the initial switch frame at the top of the stack (16-byte
+    //  aligned as required by the ABI). The MIE state of the creator is
+    //  passed in s0.
+    uintptr_t top = ((uintptr_t)stack + stack_bytes) & ~(uintptr_t)0xf;
+    uintptr_t sp  = top - CONTEXT_SWITCH_FRAME_SIZE;
+    memset((void*)sp, 0, CONTEXT_SWITCH_FRAME_SIZE);
+    *(uintptr_t*)(sp + CONTEXT_FRAME_RA) = (uintptr_t)uthread_start;
+    *(uintptr_t*)(sp + CONTEXT_FRAME_S0) = mie;
+
+    t->sp     = sp;
+    t->func   = func;
+    t->args   = args;
+    t->wakeup = 0;
+    t->prio   = 0;
+    t->joiner = NULL;
+    t->state  = UTHREAD_READY;
+
+    uthread_sched_t *s = __uthread_get_sched();
+    __uthread_enqueue(&s->ready[0], t);
+    __uthread_timer_update(s);
+    __uthread_irq_restore(mie);
+    return 0;
+}
+
+int uthread_set_priority(uthread_t *t, int prio)
+{
+    if ((prio < 0) || (prio >= UTHREAD_NPRIO)) return -1;
+
+    uintptr_t mie = __uthread_irq_save();
+    uthread_sched_t *s = __uthread_get_sched();
+    if (t->state == UTHREAD_READY) {
+        __uthread_remove(&s->ready[t->prio], t);
+        __uthread_enqueue(&s->ready[prio], t);
+    }
+    t->prio = prio;
+    __uthread_irq_restore(mie);
+    return 0;
+}
+
+void uthread_yield()
+{
+    uintptr_t mie = __uthread_irq_save();
+    __uthread_schedule(__uthread_get_sched());
+    __uthread_irq_restore(mie);
+}
+
+void uthread_sleep(uint64_t cycles)
+{
+    uintptr_t mie = __uthread_irq_save();
+    uthread_sched_t *s = __uthread_get_sched();
+    uthread_t *t = s->current;
+
+    t->wakeup = cpu_cycles() + cycles;
+    t->state  = UTHREAD_SLEEPING;
+    __uthread_enqueue(&s->sleeping, t);
+    __uthread_schedule(s);
+    __uthread_irq_restore(mie);
+}
+
+void uthread_exit()
+{
+    __uthread_irq_save();
+    uthread_sched_t *s = __uthread_get_sched();
+    uthread_t *t = s->current;
+
+    t->state = UTHREAD_DONE;
+    if (t->joiner != NULL) {
+        t->joiner->state = UTHREAD_READY;
+        __uthread_enqueue(&s->ready[t->joiner->prio], t->joiner);
+    }
+    __uthread_schedule(s);
+
+    //  Unreachable: a terminated thread is never scheduled again
+    for (;;);
+}
+
+void uthread_join(uthread_t *t)
+{
+    uintptr_t mie = __uthread_irq_save();
+    uthread_sched_t *s = __uthread_get_sched();
+
+    if (t->state != UTHREAD_DONE) {
+        t->joiner = s->current;
+        s->current->state = UTHREAD_BLOCKED;
+        __uthread_schedule(s);
+    }
+    __uthread_irq_restore(mie);
+}
+
+uthread_t* uthread_self()
+{
+    return __uthread_get_sched()->current;
+}
+
+void uthread_preempt_enable(uintptr_t period, int flags)
+{
+    uintptr_t mie = __uthread_irq_save();
+    uthread_sched_t *s = __uthread_get_sched();
+
+    if (!s->preempt) s->saved_mie = mie;
+    s->period  = period;
+    s->flags   = flags;
+    s->preempt = 1;
+    set_irq_tim_handler(cpu_id(), __uthread_tick);
+    __uthread_timer_update(s);
+    cpu_enable_machine_timer_irq();
+    __uthread_irq_restore(mie);
+
+    cpu_enable_interrupts();
+}
+
+static void __uthread_timer_stop()
+{
+    cpu_disable_machine_timer_irq();
+    clint_set_mtimecmp(cpu_list[mp_get_self_sid()].clint_drv, cpu_id(),
+            (uintptr_t)-1ULL);
+}
+
+void uthread_preempt_disable()
+{
+    uintptr_t mie = __uthread_irq_save();
+    uthread_sched_t *s = __uthread_get_sched();
+
+    if (s->preempt) {
+        s->preempt = 0;
+        mie = s->saved_mie;
+    }
+    __uthread_timer_stop();
+    __uthread_irq_restore(mie);
+}
+
+void uthread_sched_reset()
+{
+    uthread_sched_t *s = this_cpu_ptr(__uthread_sched);
+    if (s->initialized && s->preempt) __uthread_timer_stop();
+    s->initialized = 0;
+}
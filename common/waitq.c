@@ -0,0 +1,96 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   common/waitq.c
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to park CPUs
+ *          in low-power mode (WFI) until they are woken by another CPU
+ */
+#include "common/waitq.h"
+#include "common/cache.h"
+#include "common/cpu.h"
+#include "common/mp.h"
+
+void waitq_init(waitq_t *q)
+{
+    atomic_store_uncached(&q->nwaiters, 0);
+    atomic_store_uncached(&q->next, 0);
+    for (int i = 0; i < BSP_CONFIG_NCPUS; i++) {
+        atomic_store_uncached(&q->slot[i].state, WAITQ_IDLE);
+    }
+    cpu_dfence();
+}
+
+void waitq_destroy(waitq_t *q)
+{
+}
+
+void waitq_prepare(waitq_t *q)
+{
+    atomic_store_uncached(&q->slot[mp_get_self_sid()].state, WAITQ_WAITING);
+    atomic_fetch_add(&q->nwaiters, 1);
+}
+
+void waitq_cancel(waitq_t *q)
+{
+    //  A wake-up may have been sent to this CPU in the meantime. The waiter
+    //  rechecks its condition after waking-up, so this is harmless.
+    atomic_store_uncached(&q->slot[mp_get_self_sid()].state, WAITQ_IDLE);
+    atomic_fetch_sub(&q->nwaiters, 1);
+}
+
+void waitq_wait(waitq_t *q)
+{
+    waitq_slot_t *slot = &q->slot[mp_get_self_sid()];
+
+    while (atomic_load_uncached(&slot->state) != WAITQ_NOTIFIED) {
+        mp_wait_for_wakeup();
+    }
+    atomic_store_uncached(&slot->state, WAITQ_IDLE);
+    atomic_fetch_sub(&q->nwaiters, 1);
+}
+
+static int __waitq_wake(waitq_t *q, int max)
+{
+    int woken = 0;
+
+    //  Make sure that the condition is visible before checking for waiters
+    cpu_dfence();
+    if (atomic_load_uncached(&q->nwaiters) == 0) return 0;
+
+    int first = atomic_fetch_add(&q->next, 1);
+    for (int i = 0; (i < BSP_CONFIG_NCPUS) && (woken < max); i++) {
+        int sid = (unsigned)(first + i) % BSP_CONFIG_NCPUS;
+        int expected = WAITQ_WAITING;
+        if (atomic_compare_exchange_strong(&q->slot[sid].state, &expected,
+                    WAITQ_NOTIFIED)) {
+            mp_wakeup_cpu(sid);
+            woken++;
+        }
+    }
+    return woken;
+}
+
+int waitq_wake_one(waitq_t *q)
+{
+    return __waitq_wake(q, 1);
+}
+
+int waitq_wake_all(waitq_t *q)
+{
+    return __waitq_wake(q, BSP_CONFIG_NCPUS);
+}
@@ -54,6 +54,16 @@ void clint_send_ipi(clint_drv_t *dev, int target_core)
     iowritew(dev->base + (CLINT_MSIP_OFFSET + 4*target_core), 0x1);
 }
 
+/* send an IPI to n cores: the MSIP registers are written back-to-back */
+void clint_send_ipi_multi(clint_drv_t *dev, const int *target_core, int n)
+{
+    int i;
+
+    for (i = 0; i < n; ++i) {
+        iowritew(dev->base + (CLINT_MSIP_OFFSET + 4*target_core[i]), 0x1);
+    }
+}
+
 int clint_recv_ipi(clint_drv_t *dev, int target_core)
 {
     const uintptr_t offset = CLINT_MSIP_OFFSET + 4*target_core;
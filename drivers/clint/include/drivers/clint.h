@@ -36,6 +36,7 @@ typedef struct {
 
 void clint_init(clint_drv_t *dev, uintptr_t base, int ncores);
 void clint_send_ipi(clint_drv_t *dev, int target_core);
+void clint_send_ipi_multi(clint_drv_t *dev, const int *target_core, int n);
 int clint_recv_ipi(clint_drv_t *dev, int target_core);
 void clint_clear_ipi(clint_drv_t *dev, int target_core);
 void clint_set_mtimecmp(clint_drv_t *dev, int target_core, uintptr_t mtimecmp);
@@ -55,5 +55,6 @@
 void uart16550_init(uintptr_t base);
 void uart16550_putchar(char c);
 int uart16550_getchar();
+int uart16550_rx_ready();
 
 #endif /* __UART16550_H__ */
@@ -80,3 +80,9 @@ int uart16550_getchar()
 {
     return (int)uart_read(uart16550_base | UART16550_RBR);
 }
+
+int uart16550_rx_ready()
+{
+    /* Data Ready bit of the Line Status Register */
+    return (int)(uart_read(uart16550_base | UART16550_LSR) & 0x1);
+}
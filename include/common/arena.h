@@ -0,0 +1,59 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/arena.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines used to allocate memory from
+ *          per-CPU arenas
+ *
+ *  Each CPU owns an arena with one free list per size class. Small blocks
+ *  are allocated and freed by their owner CPU without locks nor atomic
+ *  operations. Blocks freed by another CPU are pushed (lock-free) to the
+ *  remote free list of the owner, which recycles them on its next
+ *  allocation. Arenas are refilled by chunks from malloc (the only
+ *  operation taking the allocator lock), and blocks larger than the biggest
+ *  size class are allocated directly by malloc.
+ *
+ *  The local arena is updated with interrupts masked. Thus, arenas can be
+ *  used by preemptive user-level threads, but not from trap handlers.
+ */
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+#ifndef ARENA_CHUNK_SIZE
+#define ARENA_CHUNK_SIZE 16384    /* bytes taken from malloc on refill */
+#endif
+
+#define ARENA_NCLASSES   8
+#define ARENA_MIN_SIZE   16
+#define ARENA_MAX_SIZE   (ARENA_MIN_SIZE << (ARENA_NCLASSES - 1))
+
+/**
+ *  Allocates a block of at least size bytes, aligned to 16 bytes, from the
+ *  arena of the executing CPU. It returns NULL if there is not enough
+ *  memory.
+ */
+void *arena_alloc(size_t size);
+
+/**
+ *  Frees a block allocated by arena_alloc. It can be called from any CPU.
+ */
+void arena_free(void *p);
+
+#endif /* __ARENA_H__ */
@@ -0,0 +1,66 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/backoff.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the backoff policies used by busy-waiting
+ *          synchronization primitives
+ *
+ *  - Exponential: the delay doubles after each failed attempt, from a minimum
+ *    up to a maximum (cap). A fixed delay is obtained with min == max.
+ *  - Proportional: the delay is proportional to the distance to the lock
+ *    owner (e.g. the number of tickets ahead in a ticket mutex), and capped.
+ */
+#ifndef __BACKOFF_H__
+#define __BACKOFF_H__
+
+#include "common/cpu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int delay;
+    int max;
+} backoff_t;
+
+static inline void backoff_init(backoff_t *b, int min, int max)
+{
+    b->delay = (min > 0) ? min : 1;
+    b->max   = (max > b->delay) ? max : b->delay;
+}
+
+static inline void backoff_exponential(backoff_t *b)
+{
+    cpu_delay(b->delay);
+    b->delay <<= 1;
+    if (b->delay > b->max) b->delay = b->max;
+}
+
+static inline void backoff_proportional(int distance, int unit, int max)
+{
+    int delay = distance*unit;
+    if ((delay > max) || (delay < 0)) delay = max;
+    cpu_delay(delay);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BACKOFF_H__ */
@@ -0,0 +1,94 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/barrier.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to
+ *          synchronize multiple CPUs with barriers
+ *
+ *  The participants of a barrier of N CPUs are the logical CPUs 0 to N-1.
+ */
+#ifndef __BARRIER_H__
+#define __BARRIER_H__
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "bsp/bsp_config.h"
+#include "common/cache.h"
+
+#define BARRIER_MAX_ROUNDS BSP_CONFIG_HARTID_BITS
+
+/*
+ *  Barrier flags
+ */
+#define BARRIER_WFI  (1 << 0)  /* waiters sleep in WFI and are woken by IPIs */
+
+enum barrier_kind_e {
+    /* Shared counter with sense reversal */
+    BARRIER_CENTRALIZED = 0,
+
+    /* Combining binary tree (arrival and release) */
+    BARRIER_TREE,
+
+    /* Dissemination (log2(N) rounds of pairwise signaling) */
+    BARRIER_DISSEMINATION
+};
+
+typedef struct barrier_cpu_s
+{
+    /* Private state of the CPU: local sense or episode number */
+    atomic_int local;
+
+    /* Tree: episode number of the last arrival of this node's subtree */
+    atomic_int arrive __cl_aligned__;
+
+    /* Tree: episode number of the last release of this node */
+    atomic_int release __cl_aligned__;
+
+    /* Dissemination: episode number of the last signal of each round */
+    atomic_int round[BARRIER_MAX_ROUNDS] __cl_aligned__;
+} __cl_aligned__ barrier_cpu_t;
+
+typedef struct barrier_s
+{
+    enum barrier_kind_e kind;
+    int ncpus;
+    int flags;
+
+    /* Centralized: count of CPUs still to arrive and global sense */
+    atomic_int count __cl_aligned__;
+    atomic_int sense __cl_aligned__;
+
+    barrier_cpu_t cpu[BSP_CONFIG_NCPUS];
+} barrier_t;
+
+int barrier_init(barrier_t *b, enum barrier_kind_e kind, int ncpus, int flags);
+void barrier_destroy(barrier_t *b);
+void barrier_wait(barrier_t *b);
+
+/**
+ *  Measures the latency of a barrier with ncpus participants.
+ *
+ *  The barrier is executed niters times by the calling CPU and ncpus-1 worker
+ *  threads. With BARRIER_WFI, workers also wait in low-power mode between
+ *  dispatches. It returns the average number of cycles per barrier episode,
+ *  or 0 if the workers cannot be created.
+ */
+uint64_t barrier_measure_latency(enum barrier_kind_e kind, int flags,
+        int ncpus, int niters);
+
+#endif /* __BARRIER_H__ */
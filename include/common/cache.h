@@ -35,6 +35,14 @@ extern "C" {
 #define __cacheline_aligned__  __cacheblock_aligned__
 #define __cl_aligned__         __cacheblock_aligned__
 
+/*
+ *  Load and store of words shared among CPUs. Atomic operations are handled
+ *  as uncacheable and work even with no hardware cache-coherency. The
+ *  pointer shall designate an atomic object.
+ */
+#define atomic_load_uncached(p)     atomic_fetch_or((p), 0)
+#define atomic_store_uncached(p, v) atomic_exchange((p), (v))
+
 static inline size_t cpu_icache_get_size()
 {
     return BSP_CONFIG_ICACHE_NWAYS*BSP_CONFIG_ICACHE_NSETS*BSP_CONFIG_ICACHE_LINE_BYTES;
@@ -65,6 +73,11 @@ static inline void cpu_dcache_invalidate()
     bsp_dcache_invalidate();
 }
 
+static inline void cpu_dcache_clean()
+{
+    bsp_dcache_clean();
+}
+
 static inline void cpu_icache_invalidate_address(uintptr_t addr)
 {
 #if BSP_CONFIG_ICACHE_INVALIDATE_LINE_IS_SUPPORTED
@@ -83,6 +96,30 @@ static inline void cpu_dcache_invalidate_address(uintptr_t addr)
 #endif
 }
 
+static inline void cpu_dcache_clean_address(uintptr_t addr)
+{
+#if BSP_CONFIG_DCACHE_CLEAN_LINE_IS_SUPPORTED
+    bsp_dcache_clean_address(addr);
+#else
+    bsp_dcache_clean();
+#endif
+}
+
+/*
+ *  Zeroes the cache line containing the given address (aligned on a line)
+ *  without fetching it from memory first. Without hardware support, the line
+ *  is zeroed with word stores.
+ */
+static inline void cpu_dcache_zero_address(uintptr_t addr)
+{
+#if BSP_CONFIG_DCACHE_ZERO_LINE_IS_SUPPORTED
+    bsp_dcache_zero_address(addr);
+#else
+    volatile unsigned long *p = (volatile unsigned long*)addr;
+    for (int i = 0; i < BSP_CONFIG_DCACHE_LINE_BYTES/sizeof(long); i++) p[i] = 0;
+#endif
+}
+
 static inline void cpu_icache_prefetch_address(uintptr_t addr)
 {
 #if BSP_CONFIG_ICACHE_PREFETCH_LINE_IS_SUPPORTED
@@ -137,6 +174,21 @@ static inline void cpu_dcache_invalidate_range(uintptr_t addr, size_t bytes)
 #endif
 }
 
+static inline void cpu_dcache_clean_range(uintptr_t addr, size_t bytes)
+{
+    if (bytes == 0) return;
+
+#if BSP_CONFIG_DCACHE_CLEAN_LINE_IS_SUPPORTED
+    uintptr_t nline_base = addr               >> BSP_CONFIG_DCACHE_LINE_OFFSET;
+    uintptr_t nline_end  = (addr + bytes - 1) >> BSP_CONFIG_DCACHE_LINE_OFFSET;
+    for (uintptr_t n = nline_base; n <= nline_end; n++) {
+        cpu_dcache_clean_address(n << BSP_CONFIG_DCACHE_LINE_OFFSET);
+    }
+#else
+    cpu_dcache_clean();
+#endif
+}
+
 static inline void cpu_icache_prefetch_range(uintptr_t addr, size_t bytes)
 {
     if (bytes == 0) return;
@@ -0,0 +1,133 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/chan.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to exchange
+ *          messages between CPUs through channels
+ *
+ *  A channel is a bounded queue of fixed-size messages. Each message is
+ *  stored in its own cache line, next to a sequence number telling whether
+ *  the slot is ready to be written or read. Any number of CPUs can send or
+ *  receive messages on a channel.
+ *
+ *  The slots are provided by the caller. They can be placed either in the
+ *  uncached memory region (.data, .bss) or in the cached one. In the latter
+ *  case, senders clean and receivers invalidate the messages, so channels
+ *  work even with no hardware cache coherency. The sequence number, which is
+ *  accessed with atomic operations, has its own cache line: cleaning a
+ *  message never writes back a stale sequence number.
+ *
+ *  Buffers can be handed from one CPU to another without copy (see
+ *  chan_send_buf and chan_recv_buf). The sender loses the ownership of the
+ *  buffer when sending it.
+ */
+#ifndef __CHAN_H__
+#define __CHAN_H__
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include "common/cache.h"
+#include "common/waitq.h"
+
+/*
+ *  Maximum size of the messages (one cache line)
+ */
+#define CHAN_MSG_MAX_BYTES BSP_CONFIG_DCACHE_LINE_BYTES
+
+/*
+ *  Channel flags
+ */
+#define CHAN_NOTIFY  (1 << 0)  /* waiters sleep in WFI and are woken by IPIs */
+
+typedef struct chan_slot_s
+{
+    atomic_ulong seq __cl_aligned__;
+    unsigned char msg[CHAN_MSG_MAX_BYTES] __cl_aligned__;
+} chan_slot_t;
+
+/*
+ *  Message used to hand a buffer over
+ */
+typedef struct chan_buf_s
+{
+    void *buf;
+    size_t bytes;
+} chan_buf_t;
+
+typedef struct chan_s
+{
+    /* Next position to be written (senders) */
+    atomic_ulong head __cl_aligned__;
+
+    /* Next position to be read (receivers) */
+    atomic_ulong tail __cl_aligned__;
+
+    /* Read-only fields */
+    chan_slot_t *slot __cl_aligned__;
+    unsigned long mask;
+    size_t msg_bytes;
+    int flags;
+
+    /* CPUs waiting for a message (recvq) or for a free slot (sendq) */
+    waitq_t recvq;
+    waitq_t sendq;
+} chan_t;
+
+/**
+ *  Initializes the channel with nslots slots (power of 2) and messages of
+ *  msg_bytes bytes (up to CHAN_MSG_MAX_BYTES). It returns 0 on success, -1 if
+ *  the arguments are not valid.
+ */
+int chan_init(chan_t *c, chan_slot_t *slot, size_t nslots, size_t msg_bytes,
+        int flags);
+void chan_destroy(chan_t *c);
+
+/**
+ *  Sends a message. It returns 0 on success, -1 if the channel is full.
+ */
+int chan_try_send(chan_t *c, const void *msg);
+
+/**
+ *  Sends a message. It waits while the channel is full.
+ */
+void chan_send(chan_t *c, const void *msg);
+
+/**
+ *  Receives a message. It returns 0 on success, -1 if the channel is empty.
+ */
+int chan_try_recv(chan_t *c, void *msg);
+
+/**
+ *  Receives a message. It waits while the channel is empty.
+ */
+void chan_recv(chan_t *c, void *msg);
+
+/**
+ *  Hands a buffer over to the receiver. The buffer is cleaned from the cache
+ *  of the sender. The channel messages shall be at least of
+ *  sizeof(chan_buf_t) bytes. It returns 0 on success, -1 otherwise.
+ */
+int chan_send_buf(chan_t *c, void *buf, size_t bytes);
+
+/**
+ *  Receives a buffer. The buffer is invalidated from the cache of the
+ *  receiver, which becomes its owner. It returns 0 on success, -1 otherwise.
+ */
+int chan_recv_buf(chan_t *c, void **buf, size_t *bytes);
+
+#endif /* __CHAN_H__ */
@@ -0,0 +1,126 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/collective.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the collective operations (broadcast,
+ *          reduction and prefix scan) across multiple CPUs
+ *
+ *  The participants of a collective of N CPUs are the logical CPUs 0 to N-1.
+ *  All of them shall call the same collective operations in the same order.
+ *
+ *  Broadcast and reductions use a binomial tree (O(log N) steps). Values are
+ *  combined in the order of the logical CPU IDs when the root is 0. Thus, the
+ *  combiner shall be associative, and also commutative for other roots.
+ *  The prefix scan uses log2(N) steps of pairwise combinations followed by a
+ *  barrier.
+ */
+#ifndef __COLLECTIVE_H__
+#define __COLLECTIVE_H__
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "bsp/bsp_config.h"
+#include "common/barrier.h"
+#include "common/cache.h"
+
+/*
+ *  Collective flags
+ */
+#define COLL_WFI  BARRIER_WFI  /* waiters sleep in WFI and are woken by IPIs */
+
+typedef union coll_value_u
+{
+    int64_t  i64;
+    uint64_t u64;
+    double   f64;
+    void    *ptr;
+} coll_value_t;
+
+typedef coll_value_t (*coll_op_t)(coll_value_t a, coll_value_t b);
+
+typedef struct coll_slot_s
+{
+    /* Private state of the CPU: episode number */
+    atomic_int local;
+
+    /* Episode numbers of the last up-sweep and down-sweep of the tree */
+    atomic_int up;
+    atomic_int down;
+
+    /* Value sent to the parent (up-sweep) or to the children (down-sweep) */
+    atomic_ullong value;
+
+    /* Scan: value and episode number of each step */
+    atomic_ullong scan_value[BARRIER_MAX_ROUNDS] __cl_aligned__;
+    atomic_int scan_episode[BARRIER_MAX_ROUNDS];
+} __cl_aligned__ coll_slot_t;
+
+typedef struct coll_s
+{
+    int ncpus;
+    int flags;
+    barrier_t barrier;
+    coll_slot_t slot[BSP_CONFIG_NCPUS];
+} coll_t;
+
+int coll_init(coll_t *c, int ncpus, int flags);
+void coll_destroy(coll_t *c);
+
+/**
+ *  Returns the value of the root CPU on all CPUs
+ */
+coll_value_t coll_bcast(coll_t *c, int root, coll_value_t v);
+
+/**
+ *  Combines the values of all CPUs. The result is valid on the root CPU.
+ */
+coll_value_t coll_reduce(coll_t *c, int root, coll_value_t v, coll_op_t op);
+
+/**
+ *  Combines the values of all CPUs. The result is returned on all CPUs.
+ */
+coll_value_t coll_allreduce(coll_t *c, coll_value_t v, coll_op_t op);
+
+/**
+ *  Inclusive prefix scan: CPU i gets v[0] op v[1] op ... op v[i]
+ */
+coll_value_t coll_scan(coll_t *c, coll_value_t v, coll_op_t op);
+
+/*
+ *  Predefined combiners
+ */
+coll_value_t coll_op_sum_i64(coll_value_t a, coll_value_t b);
+coll_value_t coll_op_min_i64(coll_value_t a, coll_value_t b);
+coll_value_t coll_op_max_i64(coll_value_t a, coll_value_t b);
+coll_value_t coll_op_sum_f64(coll_value_t a, coll_value_t b);
+coll_value_t coll_op_min_f64(coll_value_t a, coll_value_t b);
+coll_value_t coll_op_max_f64(coll_value_t a, coll_value_t b);
+
+static inline coll_value_t coll_i64(int64_t v)
+{
+    coll_value_t r = { .i64 = v };
+    return r;
+}
+
+static inline coll_value_t coll_f64(double v)
+{
+    coll_value_t r = { .f64 = v };
+    return r;
+}
+
+#endif /* __COLLECTIVE_H__ */
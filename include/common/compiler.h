@@ -30,8 +30,11 @@
 #define __packed__        __PACKED__
 #define __likely(x)       __builtin_expect((x),1)
 #define __unlikely(x)     __builtin_expect((x),0)
+#define __NO_LIBCALL__    __attribute__ ((optimize("no-tree-loop-distribute-patterns")))
 #define __CACHED__        __attribute__ ((section(".data.cached")))
 #define __cached__        __CACHED__
+#define __CACHED_BSS__    __attribute__ ((section(".bss.cached")))
+#define __cached_bss__    __CACHED_BSS__
 #define STR1(x)           #x
 #define STR(x)            STR1(x)
 
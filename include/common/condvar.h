@@ -0,0 +1,55 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/condvar.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          condition variables
+ *
+ *  Waiters sleep in low-power mode (WFI) until they are signaled. As usual,
+ *  waiters shall check their condition in a loop: wake-ups may be spurious.
+ */
+#ifndef __CONDVAR_H__
+#define __CONDVAR_H__
+
+#include "common/sleep_mutex.h"
+#include "common/waitq.h"
+
+typedef struct {
+    waitq_t waitq;
+} condvar_t;
+
+void condvar_init(condvar_t *c);
+void condvar_destroy(condvar_t *c);
+
+/**
+ *  Atomically releases the mutex and waits for the condition variable to be
+ *  signaled. The mutex is acquired again before returning.
+ */
+void condvar_wait(condvar_t *c, sleep_mutex_t *m);
+
+/**
+ *  Wakes up one waiter of the condition variable
+ */
+void condvar_signal(condvar_t *c);
+
+/**
+ *  Wakes up all the waiters of the condition variable
+ */
+void condvar_broadcast(condvar_t *c);
+
+#endif /* __CONDVAR_H__ */
@@ -0,0 +1,510 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/coro.hpp
+ *  @author Cesar Fuguet
+ *  @brief  C++20 coroutine support: task type, single-threaded executor per
+ *          CPU and awaitable events (timer, UART, IPI)
+ *
+ *  Applications using this header shall be compiled with C++20 or newer
+ *  (CXXSTD = c++20 in the application makefile).
+ *
+ *  Coroutine frames are allocated from a per-CPU pool of fixed-size blocks
+ *  (CORO_FRAME_BYTES x CORO_POOL_FRAMES) placed in the cached BSS section
+ *  (not stored in the image). Larger frames, or frames allocated when the
+ *  pool is exhausted, fall back to malloc.
+ *
+ *  The UART awaitable (uart_getchar) is only available when the UART 16550
+ *  is the console (TTY_UART16550).
+ *
+ *  Example:
+ *
+ *      coro::task<int> child() { co_await coro::sleep_for(1000); co_return 1; }
+ *      coro::task<> parent() { int v = co_await child(); ... }
+ *
+ *      coro::executor::local().spawn(parent());
+ *      coro::executor::local().run();
+ */
+#ifndef __CORO_HPP__
+#define __CORO_HPP__
+
+#if __cplusplus < 202002L
+#error "coro.hpp requires C++20 or newer (CXXSTD = c++20)"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+#include "bsp/bsp_config.h"
+#include "common/cache.h"
+#include "common/compiler.h"
+#include "common/cpu.h"
+
+extern "C" {
+#include "common/mp.h"
+#ifdef TTY_UART16550
+#include "drivers/uart16550.h"
+#endif
+}
+
+#ifndef CORO_FRAME_BYTES
+#define CORO_FRAME_BYTES 512
+#endif
+#ifndef CORO_POOL_FRAMES
+#define CORO_POOL_FRAMES 32
+#endif
+#ifndef CORO_READY_MAX
+#define CORO_READY_MAX   64    /* must be a power of 2 */
+#endif
+#ifndef CORO_POLL_PERIOD
+#define CORO_POLL_PERIOD 16    /* resumes between two polls of the events */
+#endif
+#ifndef CORO_IDLE_DELAY
+#define CORO_IDLE_DELAY  100
+#endif
+
+static_assert((CORO_READY_MAX & (CORO_READY_MAX - 1)) == 0,
+        "CORO_READY_MAX shall be a power of 2");
+
+namespace coro {
+
+template<typename T = void> class task;
+
+namespace detail {
+
+inline int self_sid() noexcept
+{
+    return mp_get_self_sid();
+}
+
+/*
+ *  Pool of coroutine frames. It is only accessed by its CPU.
+ */
+class frame_pool
+{
+public:
+    void* allocate(std::size_t bytes) noexcept
+    {
+        if (bytes <= CORO_FRAME_BYTES) {
+            if (free_ != nullptr) {
+                block *b = free_;
+                free_ = b->next;
+                return b;
+            }
+            if (next_ < CORO_POOL_FRAMES) return &arena_[next_++];
+        }
+        return std::malloc(bytes);
+    }
+
+    void deallocate(void *p) noexcept
+    {
+        if (!owns(p)) {
+            std::free(p);
+            return;
+        }
+        block *b = static_cast<block*>(p);
+        b->next = free_;
+        free_ = b;
+    }
+
+private:
+    union __cl_aligned__ block
+    {
+        block *next;
+        unsigned char data[CORO_FRAME_BYTES];
+    };
+
+    bool owns(void *p) const noexcept
+    {
+        uintptr_t a = reinterpret_cast<uintptr_t>(p);
+        return (a >= reinterpret_cast<uintptr_t>(&arena_[0])) &&
+               (a <  reinterpret_cast<uintptr_t>(&arena_[CORO_POOL_FRAMES]));
+    }
+
+    /* Zero-initialized: blocks are taken from the arena on first use */
+    block arena_[CORO_POOL_FRAMES];
+    block *free_;
+    std::size_t next_;
+};
+
+inline frame_pool& pool() noexcept
+{
+    static frame_pool pools[BSP_CONFIG_NCPUS] __CACHED_BSS__;
+    return pools[self_sid()];
+}
+
+struct promise_base
+{
+    std::coroutine_handle<> continuation;
+    bool detached = false;
+
+    static void* operator new(std::size_t bytes) noexcept
+    {
+        return pool().allocate(bytes);
+    }
+
+    static void operator delete(void *p) noexcept
+    {
+        pool().deallocate(p);
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    /* On completion, resume the awaiting coroutine (if any) */
+    struct final_awaiter
+    {
+        bool await_ready() noexcept { return false; }
+
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+        {
+            promise_base &p = h.promise();
+            if (p.continuation) return p.continuation;
+            if (p.detached) h.destroy();
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    final_awaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept { std::abort(); }
+};
+
+template<typename T>
+struct promise : promise_base
+{
+    T value{};
+
+    task<T> get_return_object() noexcept;
+    static task<T> get_return_object_on_allocation_failure() noexcept;
+    void return_value(T v) { value = std::move(v); }
+};
+
+template<>
+struct promise<void> : promise_base
+{
+    task<void> get_return_object() noexcept;
+    static task<void> get_return_object_on_allocation_failure() noexcept;
+    void return_void() noexcept {}
+};
+
+} /* namespace detail */
+
+/*
+ *  Lazily started coroutine. It runs when it is awaited, spawned or run by
+ *  an executor. The result type shall be default constructible.
+ */
+template<typename T>
+class [[nodiscard]] task
+{
+public:
+    using promise_type = detail::promise<T>;
+    using handle_type  = std::coroutine_handle<promise_type>;
+
+    task() noexcept = default;
+    explicit task(handle_type h) noexcept : h_(h) {}
+    task(task &&t) noexcept : h_(std::exchange(t.h_, {})) {}
+    task(const task&) = delete;
+    task& operator=(const task&) = delete;
+
+    task& operator=(task &&t) noexcept
+    {
+        if (this != &t) {
+            if (h_) h_.destroy();
+            h_ = std::exchange(t.h_, {});
+        }
+        return *this;
+    }
+
+    ~task()
+    {
+        if (h_) h_.destroy();
+    }
+
+    /* False if the frame could not be allocated */
+    bool valid() const noexcept { return static_cast<bool>(h_); }
+    bool done() const noexcept { return !h_ || h_.done(); }
+    handle_type handle() const noexcept { return h_; }
+    handle_type release() noexcept { return std::exchange(h_, {}); }
+
+    auto operator co_await() const noexcept
+    {
+        struct awaiter
+        {
+            handle_type h;
+
+            bool await_ready() noexcept { return !h || h.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept
+            {
+                h.promise().continuation = c;
+                return h;
+            }
+
+            T await_resume() noexcept
+            {
+                if constexpr (!std::is_void_v<T>) return std::move(h.promise().value);
+            }
+        };
+        return awaiter{h_};
+    }
+
+private:
+    handle_type h_;
+};
+
+namespace detail {
+
+template<typename T>
+inline task<T> promise<T>::get_return_object() noexcept
+{
+    return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+}
+
+template<typename T>
+inline task<T> promise<T>::get_return_object_on_allocation_failure() noexcept
+{
+    return task<T>();
+}
+
+inline task<void> promise<void>::get_return_object() noexcept
+{
+    return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+}
+
+inline task<void> promise<void>::get_return_object_on_allocation_failure() noexcept
+{
+    return task<void>();
+}
+
+} /* namespace detail */
+
+/*
+ *  Coroutine suspended until an event happens. Waiters live in the frame of
+ *  the suspended coroutine.
+ */
+struct waiter
+{
+    std::coroutine_handle<> handle;
+    bool (*poll)(waiter *w);
+    waiter *next;
+    uint64_t deadline;
+};
+
+/*
+ *  Single-threaded executor. Each CPU has its own executor. Coroutines are
+ *  resumed in FIFO order. Events are polled when no coroutine is ready, and
+ *  periodically otherwise. Waiters whose event occurs while the ready queue
+ *  is full are kept in an overflow list, and moved to the ready queue as
+ *  soon as there is room.
+ */
+class executor
+{
+public:
+    static executor& local() noexcept
+    {
+        static executor executors[BSP_CONFIG_NCPUS] __CACHED__;
+        return executors[detail::self_sid()];
+    }
+
+    /* Appends the coroutine to the ready queue. It returns false if the
+     * queue is full. */
+    bool schedule(std::coroutine_handle<> h) noexcept
+    {
+        if ((tail_ - head_) == CORO_READY_MAX) return false;
+        ready_[tail_++ & (CORO_READY_MAX - 1)] = h;
+        return true;
+    }
+
+    void wait(waiter *w) noexcept
+    {
+        w->next = waiters_;
+        waiters_ = w;
+    }
+
+    /* Starts a coroutine. Its frame is released on completion. It returns
+     * false, and the task is left untouched, if the ready queue is full. */
+    template<typename T>
+    bool spawn(task<T> &&t) noexcept
+    {
+        if (!t.valid() || !schedule(t.handle())) return false;
+        t.release().promise().detached = true;
+        return true;
+    }
+
+    /* Runs the coroutines until none is ready or waiting */
+    void run() noexcept
+    {
+        while (step()) {}
+    }
+
+    /* Runs the coroutines until the given task completes */
+    template<typename T>
+    T run(task<T> &&t) noexcept
+    {
+        task<T> owned = std::move(t);
+        if (!owned.valid()) return T();
+
+        //  Make room in the ready queue if needed
+        while (!schedule(owned.handle())) step();
+        while (!owned.done() && step()) {}
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(owned.handle().promise().value);
+        }
+    }
+
+    /* Resumes one coroutine, or polls the events. It returns false when
+     * there is nothing left to do. */
+    bool step() noexcept
+    {
+        drain();
+        if (head_ != tail_) {
+            if (++resumes_ % CORO_POLL_PERIOD == 0) poll();
+            std::coroutine_handle<> h = ready_[head_++ & (CORO_READY_MAX - 1)];
+            h.resume();
+            return true;
+        }
+        if ((waiters_ == nullptr) && (overflow_ == nullptr)) return false;
+
+        poll();
+        if (head_ == tail_) cpu_delay(CORO_IDLE_DELAY);
+        return true;
+    }
+
+private:
+    void poll() noexcept
+    {
+        waiter **pw = &waiters_;
+        while (*pw != nullptr) {
+            waiter *w = *pw;
+            if (w->poll(w)) {
+                *pw = w->next;
+                if (!schedule(w->handle)) {
+                    //  The ready queue is full: defer the waiter
+                    w->next = nullptr;
+                    if (overflow_ == nullptr) overflow_ = w;
+                    else                      overflow_tail_->next = w;
+                    overflow_tail_ = w;
+                }
+            } else {
+                pw = &w->next;
+            }
+        }
+    }
+
+    void drain() noexcept
+    {
+        while ((overflow_ != nullptr) && schedule(overflow_->handle)) {
+            overflow_ = overflow_->next;
+        }
+    }
+
+    std::coroutine_handle<> ready_[CORO_READY_MAX];
+    std::size_t head_;
+    std::size_t tail_;
+    std::size_t resumes_;
+    waiter *waiters_;
+    waiter *overflow_;
+    waiter *overflow_tail_;
+};
+
+/*
+ *  Awaitable events
+ */
+class event_awaiter
+{
+public:
+    explicit event_awaiter(bool (*poll)(waiter*), uint64_t deadline = 0) noexcept
+    {
+        w_.poll = poll;
+        w_.deadline = deadline;
+    }
+
+    bool await_ready() noexcept { return w_.poll(&w_); }
+
+    void await_suspend(std::coroutine_handle<> h) noexcept
+    {
+        w_.handle = h;
+        executor::local().wait(&w_);
+    }
+
+    void await_resume() noexcept {}
+
+private:
+    waiter w_;
+};
+
+/* Gives the CPU to the other ready coroutines */
+inline auto yield() noexcept
+{
+    struct awaiter
+    {
+        bool await_ready() noexcept { return false; }
+
+        //  Keep running if the ready queue is full
+        bool await_suspend(std::coroutine_handle<> h) noexcept
+        {
+            return executor::local().schedule(h);
+        }
+        void await_resume() noexcept {}
+    };
+    return awaiter{};
+}
+
+/* Suspends the coroutine during (at least) the given number of cycles */
+inline event_awaiter sleep_for(uint64_t cycles) noexcept
+{
+    return event_awaiter([](waiter *w) { return cpu_cycles() >= w->deadline; },
+            cpu_cycles() + cycles);
+}
+
+/* Suspends the coroutine until an inter-processor interrupt is received
+ * (see mp_wakeup_cpu) */
+inline event_awaiter wait_ipi() noexcept
+{
+    return event_awaiter([](waiter*) { return mp_poll_wakeup() != 0; });
+}
+
+#ifdef TTY_UART16550
+/* Suspends the coroutine until a character is received by the UART. It
+ * returns the character. */
+inline auto uart_getchar() noexcept
+{
+    struct awaiter : event_awaiter
+    {
+        awaiter() noexcept :
+            event_awaiter([](waiter*) { return uart16550_rx_ready() != 0; }) {}
+        int await_resume() noexcept { return uart16550_getchar(); }
+    };
+    return awaiter{};
+}
+#endif /* TTY_UART16550 */
+
+/* Wakes up a coroutine of another CPU waiting in wait_ipi */
+inline void notify_cpu(int cpu_id) noexcept
+{
+    mp_wakeup_cpu(cpu_id);
+}
+
+} /* namespace coro */
+
+#endif /* __CORO_HPP__ */
@@ -107,14 +107,14 @@ static inline void cpu_mfence()
 
 static inline int cpu_id()
 {
-    register int ret;
+    int ret;
     asm volatile ("csrr %0, mhartid\n" : "=r"(ret));
     return ret;
 }
 
 static inline void cpu_delay(int ncycles)
 {
-    register int niters = ncycles / 3;
+    int niters = ncycles / 3;
 
     asm volatile (
             "1:                                 \n"
@@ -139,7 +139,7 @@ static inline void cpu_set_thread_pointer(uintptr_t p)
 
 static inline uintptr_t cpu_get_thread_pointer()
 {
-    register uintptr_t ptr;
+    uintptr_t ptr;
 
     asm volatile (
             "add    %[ret], tp, x0              \n"
@@ -151,6 +151,30 @@ static inline uintptr_t cpu_get_thread_pointer()
     return ptr;
 }
 
+static inline void cpu_set_scratch(uintptr_t p)
+{
+    asm volatile (
+            "csrw   mscratch, %[ptr]            \n"
+            : /* no outputs */
+            : [ptr] "r"(p)
+            : "memory"
+    );
+}
+
+static inline uintptr_t cpu_get_scratch()
+{
+    uintptr_t ptr;
+
+    asm volatile (
+            "csrr   %[ret], mscratch            \n"
+            : [ret] "=r" (ptr)
+            : /* no inputs */
+            : "memory"
+    );
+
+    return ptr;
+}
+
 static inline void cpu_set_cycles(uint64_t value)
 {
 #if (__SIZEOF_LONG__ == 4)
@@ -173,8 +197,8 @@ static inline void cpu_set_cycles(uint64_t value)
 static inline uint64_t cpu_cycles()
 {
 #if (__SIZEOF_LONG__ == 4)
-    register uint32_t lo;
-    register uint32_t hi;
+    uint32_t lo;
+    uint32_t hi;
 
     asm volatile (
             "csrr %[lo], mcycle                  \n"
@@ -190,7 +214,7 @@ static inline uint64_t cpu_cycles()
 
     return ((uint64_t)hi << 32) | lo;
 #else
-    register uint64_t cycles;
+    uint64_t cycles;
 
     asm volatile (
             "csrr %[cycles], mcycle            \n"
@@ -224,8 +248,8 @@ static inline void cpu_set_instructions(uint64_t value)
 static inline uint64_t cpu_instructions()
 {
 #if (__SIZEOF_LONG__ == 4)
-    register uint32_t lo;
-    register uint32_t hi;
+    uint32_t lo;
+    uint32_t hi;
 
     asm volatile (
             "csrr %[lo], minstret                \n"
@@ -241,7 +265,7 @@ static inline uint64_t cpu_instructions()
 
     return ((uint64_t)hi << 32) | lo;
 #else
-    register uint64_t instrs;
+    uint64_t instrs;
 
     asm volatile (
             "csrr %[instrs], minstret          \n"
@@ -275,8 +299,8 @@ static inline void cpu_set_imiss(uint64_t value)
 static inline uint64_t cpu_imiss()
 {
 #if (__SIZEOF_LONG__ == 4)
-    register uint32_t lo;
-    register uint32_t hi;
+    uint32_t lo;
+    uint32_t hi;
 
     asm volatile (
             "csrr %[lo], mhpmcounter3       \n"
@@ -292,7 +316,7 @@ static inline uint64_t cpu_imiss()
 
     return ((uint64_t)hi << 32) | lo;
 #else
-    register uint64_t imiss;
+    uint64_t imiss;
 
     asm volatile (
             "csrr %[imiss], mhpmcounter3   \n"
@@ -326,8 +350,8 @@ static inline void cpu_set_dmiss(uint64_t value)
 static inline uint64_t cpu_dmiss()
 {
 #if (__SIZEOF_LONG__ == 4)
-    register uint32_t lo;
-    register uint32_t hi;
+    uint32_t lo;
+    uint32_t hi;
 
     asm volatile (
             "csrr %[lo], mhpmcounter4       \n"
@@ -343,7 +367,7 @@ static inline uint64_t cpu_dmiss()
 
     return ((uint64_t)hi << 32) | lo;
 #else
-    register uint64_t dmiss;
+    uint64_t dmiss;
 
     asm volatile (
             "csrr %[dmiss], mhpmcounter4   \n"
@@ -357,7 +381,7 @@ static inline uint64_t cpu_dmiss()
 
 static inline void cpu_enable_machine_all_irq()
 {
-    register uintptr_t temp = MIE_MSIE | MIE_MTIE | MIE_MEIE;
+    uintptr_t temp = MIE_MSIE | MIE_MTIE | MIE_MEIE;
     asm volatile (
             "csrrs    zero, mie, %0\n"
             :
@@ -367,7 +391,7 @@ static inline void cpu_enable_machine_all_irq()
 
 static inline void cpu_enable_machine_external_irq()
 {
-    register uintptr_t temp = MIE_MEIE;
+    uintptr_t temp = MIE_MEIE;
     asm volatile (
             "csrrs    zero, mie, %0\n"
             :
@@ -377,7 +401,7 @@ static inline void cpu_enable_machine_external_irq()
 
 static inline void cpu_enable_machine_software_irq()
 {
-    register uintptr_t temp = MIE_MSIE;
+    uintptr_t temp = MIE_MSIE;
     asm volatile (
             "csrrs    zero, mie, %0\n"
             :
@@ -387,7 +411,7 @@ static inline void cpu_enable_machine_software_irq()
 
 static inline void cpu_enable_machine_timer_irq()
 {
-    register uintptr_t temp = MIE_MTIE;
+    uintptr_t temp = MIE_MTIE;
     asm volatile (
             "csrrs    zero, mie, %0\n"
             :
@@ -397,7 +421,7 @@ static inline void cpu_enable_machine_timer_irq()
 
 static inline void cpu_disable_machine_external_irq()
 {
-    register uintptr_t temp = MIE_MEIE;
+    uintptr_t temp = MIE_MEIE;
     asm volatile (
             "csrrc    zero, mie, %0\n"
             :
@@ -407,7 +431,7 @@ static inline void cpu_disable_machine_external_irq()
 
 static inline void cpu_disable_machine_software_irq()
 {
-    register uintptr_t temp = MIE_MSIE;
+    uintptr_t temp = MIE_MSIE;
     asm volatile (
             "csrrc    zero, mie, %0\n"
             :
@@ -417,7 +441,7 @@ static inline void cpu_disable_machine_software_irq()
 
 static inline void cpu_disable_machine_timer_irq()
 {
-    register uintptr_t temp = MIE_MTIE;
+    uintptr_t temp = MIE_MTIE;
     asm volatile (
             "csrrc    zero, mie, %0\n"
             :
@@ -58,4 +58,46 @@
 #define CONTEXT_FRAME_MEPC        (32*CONTEXT_REGBYTES)
 #define CONTEXT_FRAME_MTVAL       (33*CONTEXT_REGBYTES)
 
+/*
+ *  Switch frame of user-level threads (see uthread.h). It uses the layout of
+ *  the trap frame for the callee-saved integer registers, followed by the
+ *  callee-saved floating-point registers (hard-float ABIs only)
+ */
+#if defined(__riscv_float_abi_double)
+#define CONTEXT_FPREGBYTES        8
+#elif defined(__riscv_float_abi_single)
+#define CONTEXT_FPREGBYTES        4
+#else
+#define CONTEXT_FPREGBYTES        0
+#endif
+#define CONTEXT_FRAME_FS0         (CONTEXT_FRAME_SIZE +  0*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS1         (CONTEXT_FRAME_SIZE +  1*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS2         (CONTEXT_FRAME_SIZE +  2*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS3         (CONTEXT_FRAME_SIZE +  3*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS4         (CONTEXT_FRAME_SIZE +  4*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS5         (CONTEXT_FRAME_SIZE +  5*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS6         (CONTEXT_FRAME_SIZE +  6*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS7         (CONTEXT_FRAME_SIZE +  7*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS8         (CONTEXT_FRAME_SIZE +  8*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS9         (CONTEXT_FRAME_SIZE +  9*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS10        (CONTEXT_FRAME_SIZE + 10*CONTEXT_FPREGBYTES)
+#define CONTEXT_FRAME_FS11        (CONTEXT_FRAME_SIZE + 11*CONTEXT_FPREGBYTES)
+#define CONTEXT_SWITCH_FRAME_SIZE (CONTEXT_FRAME_SIZE + 12*CONTEXT_FPREGBYTES)
+
+/*
+ *  Frame of the state that is not saved by the trap entry, nor by the switch
+ *  frame, when a thread is preempted: the return address, the caller-saved
+ *  floating-point registers and fcsr (hard-float ABIs only). When the vector
+ *  extension is enabled, the vector registers are pushed below this frame.
+ */
+#define CONTEXT_EXT_RA            ( 0*CONTEXT_REGBYTES)
+#define CONTEXT_EXT_FCSR          ( 1*CONTEXT_REGBYTES)
+#define CONTEXT_EXT_VL            ( 2*CONTEXT_REGBYTES)
+#define CONTEXT_EXT_VTYPE         ( 3*CONTEXT_REGBYTES)
+#define CONTEXT_EXT_VSTART        ( 4*CONTEXT_REGBYTES)
+#define CONTEXT_EXT_VCSR          ( 5*CONTEXT_REGBYTES)
+#define CONTEXT_EXT_FT(i)         ( 6*CONTEXT_REGBYTES + (i)*CONTEXT_FPREGBYTES)
+#define CONTEXT_EXT_FA(i)         (CONTEXT_EXT_FT(12) + (i)*CONTEXT_FPREGBYTES)
+#define CONTEXT_EXT_FRAME_SIZE    ((CONTEXT_EXT_FA(8) + 15) & ~15)
+
 #endif /* __CPU_CONTEXT_H__ */
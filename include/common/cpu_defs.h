@@ -31,6 +31,7 @@
 #define MSTATUS_SPIE        0x00000020
 #define MSTATUS_MPIE        0x00000080
 #define MSTATUS_SPP         0x00000100
+#define MSTATUS_VS          0x00000600
 #define MSTATUS_MPP         0x00001800
 #define MSTATUS_FS          0x00006000
 #define MSTATUS_XS          0x00018000
@@ -51,6 +52,11 @@
 #define MSTATUS_FS_CLEAN    0x00004000
 #define MSTATUS_FS_DIRTY    0x00006000
 
+#define MSTATUS_VS_OFF      0x00000000
+#define MSTATUS_VS_INITIAL  0x00000200
+#define MSTATUS_VS_CLEAN    0x00000400
+#define MSTATUS_VS_DIRTY    0x00000600
+
 #define MSTATUS_XS_OFF      0x00000000
 #define MSTATUS_XS_INITIAL  0x00008000
 #define MSTATUS_XS_CLEAN    0x00010000
@@ -0,0 +1,89 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/cpuset.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to handle
+ *          sets of logical CPUs
+ */
+#ifndef __CPUSET_H__
+#define __CPUSET_H__
+
+#include <stdint.h>
+#include "bsp/bsp_config.h"
+
+#define CPUSET_WORDS ((BSP_CONFIG_NCPUS + 63) / 64)
+
+typedef struct cpuset_s
+{
+    uint64_t bits[CPUSET_WORDS];
+} cpuset_t;
+
+static inline void cpuset_zero(cpuset_t *s)
+{
+    for (int i = 0; i < CPUSET_WORDS; i++) s->bits[i] = 0;
+}
+
+static inline void cpuset_fill(cpuset_t *s)
+{
+    for (int i = 0; i < BSP_CONFIG_NCPUS; i++) {
+        s->bits[i / 64] |= (uint64_t)1 << (i % 64);
+    }
+}
+
+static inline void cpuset_set(cpuset_t *s, int cpu)
+{
+    if ((cpu < 0) || (cpu >= BSP_CONFIG_NCPUS)) return;
+    s->bits[cpu / 64] |= (uint64_t)1 << (cpu % 64);
+}
+
+static inline void cpuset_clear(cpuset_t *s, int cpu)
+{
+    if ((cpu < 0) || (cpu >= BSP_CONFIG_NCPUS)) return;
+    s->bits[cpu / 64] &= ~((uint64_t)1 << (cpu % 64));
+}
+
+/* Removes from s the CPUs in other */
+static inline void cpuset_andnot(cpuset_t *s, const cpuset_t *other)
+{
+    for (int i = 0; i < CPUSET_WORDS; i++) s->bits[i] &= ~other->bits[i];
+}
+
+static inline int cpuset_isset(const cpuset_t *s, int cpu)
+{
+    if ((cpu < 0) || (cpu >= BSP_CONFIG_NCPUS)) return 0;
+    return (s->bits[cpu / 64] >> (cpu % 64)) & 1;
+}
+
+static inline int cpuset_isempty(const cpuset_t *s)
+{
+    for (int i = 0; i < CPUSET_WORDS; i++) {
+        if (s->bits[i] != 0) return 0;
+    }
+    return 1;
+}
+
+static inline int cpuset_count(const cpuset_t *s)
+{
+    int count = 0;
+    for (int i = 0; i < CPUSET_WORDS; i++) {
+        count += __builtin_popcountll(s->bits[i]);
+    }
+    return count;
+}
+
+#endif /* __CPUSET_H__ */
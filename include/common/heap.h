@@ -0,0 +1,52 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/heap.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines used to monitor the heap
+ *
+ *  The heap starts at the _end symbol and grows (with _sbrk) up to the
+ *  _heap_end symbol (see linkcmds.include). Requests beyond it fail with
+ *  ENOMEM.
+ */
+#ifndef __HEAP_H__
+#define __HEAP_H__
+
+#include <stddef.h>
+
+typedef struct heap_stats_s
+{
+    /* Maximum size of the heap (bytes) */
+    size_t limit;
+
+    /* Current size of the heap (bytes) */
+    size_t size;
+
+    /* High-water mark of the size of the heap (bytes) */
+    size_t peak;
+
+    /* Number of calls to _sbrk, and number of them that failed */
+    unsigned long sbrk_calls;
+    unsigned long sbrk_failures;
+} heap_stats_t;
+
+/**
+ *  Copies the current statistics of the heap into the given structure
+ */
+void heap_get_stats(heap_stats_t *stats);
+
+#endif /* __HEAP_H__ */
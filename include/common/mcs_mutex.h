@@ -0,0 +1,74 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/mcs_mutex.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          MCS queue mutexes (mutual exclusion locks)
+ *
+ *  Waiters are queued and each one polls its own cache-line-aligned node.
+ *  Thus, the lock handoff only touches the node of the next waiter. The mutex
+ *  embeds one node per logical CPU.
+ *
+ *  As nodes are selected by the logical ID of the CPU, interrupts are masked
+ *  from the acquisition to the release of the mutex. Thus, the mutex cannot
+ *  be acquired twice by the same CPU through a preemptive user-level thread
+ *  switch.
+ */
+#ifndef __MCS_MUTEX_H__
+#define __MCS_MUTEX_H__
+
+#ifdef __cplusplus
+  #include <atomic>
+  using std::atomic_int;
+
+  extern "C" {
+#else /* not __cplusplus */
+  #include <stdatomic.h>
+#endif /* __cplusplus */
+#include "bsp/bsp_config.h"
+#include "common/cache.h"
+
+typedef struct {
+    /* Logical ID + 1 of the next waiter (0 if none) */
+    atomic_int next;
+
+    /* Non-zero while the owner CPU of the node waits for the lock */
+    atomic_int locked;
+
+    /* Interrupt enable state of the owner CPU before the acquisition */
+    int mie;
+} __cl_aligned__ mcs_mutex_node_t;
+
+typedef struct {
+    /* Logical ID + 1 of the last waiter (0 if the mutex is free) */
+    atomic_int tail __cl_aligned__;
+    mcs_mutex_node_t node[BSP_CONFIG_NCPUS];
+} mcs_mutex_t;
+
+void mcs_mutex_init(mcs_mutex_t *m);
+void mcs_mutex_destroy(mcs_mutex_t *m);
+void mcs_mutex_lock(mcs_mutex_t *m);
+int mcs_mutex_trylock(mcs_mutex_t *m);
+void mcs_mutex_unlock(mcs_mutex_t *m);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MCS_MUTEX_H__ */
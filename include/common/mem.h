@@ -0,0 +1,45 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/mem.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the optimized routines for memory manipulation
+ *
+ *  The standard routines (memset, memcpy, memmove) are declared in string.h.
+ */
+#ifndef __MEM_H__
+#define __MEM_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Zeroes nlines cache lines starting at addr, which shall be aligned on a
+ *  cache line. When the BSP supports it (BSP_CONFIG_DCACHE_ZERO_LINE_IS_-
+ *  SUPPORTED), lines are zeroed with cache-block zero operations (cbo.zero)
+ *  and are not fetched from memory first.
+ */
+void mem_zero_lines(void *addr, size_t nlines);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MEM_H__ */
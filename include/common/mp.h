@@ -28,6 +28,8 @@
 #include <string.h>
 #include "bsp/bsp_config.h"
 #include "common/cache.h"
+#include "common/cpu.h"
+#include "common/cpuset.h"
 #include "drivers/clint.h"
 
 struct thread_s;
@@ -44,7 +46,26 @@ enum cpu_state_e {
 enum cpu_ipi_e {
     CPU_IPI_NULL = 0,
     CPU_IPI_CREATE,
-    CPU_IPI_KILL
+    CPU_IPI_KILL,
+    CPU_IPI_WAKEUP
+};
+
+/*
+ *  Placement policies used to select a free CPU
+ */
+enum mp_placement_e {
+    /* First free CPU (lowest logical ID) */
+    MP_PLACE_FIRST = 0,
+
+    /* Next free CPU after the last selected one */
+    MP_PLACE_ROUND_ROBIN,
+
+    /* Free CPU released the longest time ago (or never used) */
+    MP_PLACE_LRU,
+
+    /* Free CPU in the cluster of the calling CPU, if any (see
+     * BSP_CONFIG_CPU_CLUSTERS). Otherwise, round-robin. */
+    MP_PLACE_CLUSTER
 };
 
 typedef struct cpu_s {
@@ -87,6 +108,12 @@ typedef struct cpu_s {
      *  IPI kind (clint inter-processor interrupt)
      */
     enum cpu_ipi_e ipi_kind;
+
+    /*
+     *  Release sequence number: value of a global counter when the CPU
+     *  became idle for the last time (0 if never used)
+     */
+    unsigned long release_seq;
 } __cl_aligned__ cpu_t;
 
 /*
@@ -203,6 +230,24 @@ static inline int mp_get_cpu_count()
     return BSP_CONFIG_NCPUS;
 }
 
+/**
+ *  Returns the logical ID of the executing CPU
+ */
+static inline int mp_get_self_sid()
+{
+    return cpu_hid2sid[cpu_id()];
+}
+
+/**
+ *  Returns the cpu description structure of the executing CPU. It is kept in
+ *  the mscratch register (the thread pointer register points to the TLS
+ *  block of the CPU).
+ */
+static inline cpu_t* mp_get_self_desc()
+{
+    return (cpu_t*)cpu_get_scratch();
+}
+
 /**
  *  Returns the cpu description structure of the first free CPU in the CPU list
  *
@@ -210,4 +255,48 @@ static inline int mp_get_cpu_count()
  */
 cpu_t* mp_get_free_cpu();
 
+/**
+ *  Returns the cpu description structure of a free CPU in the given set,
+ *  selected according to the given placement policy. An empty (or NULL) set
+ *  stands for all the CPUs. Unknown policies fall back to MP_PLACE_FIRST.
+ *
+ *  It returns NULL when all CPUs of the set are busy.
+ */
+cpu_t* mp_get_free_cpu_in(const cpuset_t *set, enum mp_placement_e placement);
+
+/**
+ *  Declares the given CPU as idle, and updates its release sequence number
+ */
+void mp_release_cpu(int cpu_id);
+
+/**
+ *  Returns the cluster of the given logical CPU. CPUs of the same cluster
+ *  share a level of the memory hierarchy (e.g. an L2 cache slice).
+ */
+int mp_get_cpu_cluster(int cpu_id);
+
+/**
+ *  Sends a wake-up inter-processor interrupt to the given CPU
+ *
+ *  The IPI kind of the target CPU is set to CPU_IPI_WAKEUP only if there is no
+ *  other pending kind (a creation request is never overwritten). The wake-up
+ *  IPI is only a hint: it can be sent at any moment, even when the target CPU
+ *  is no longer waiting for it. Waiters shall always check the condition they
+ *  are waiting for after waking up.
+ */
+void mp_wakeup_cpu(int cpu_id);
+
+/**
+ *  Puts the executing CPU in low-power mode (WFI) until an IPI is pending.
+ *  The pending IPI, and its CPU_IPI_WAKEUP kind, are acknowledged before
+ *  returning.
+ */
+void mp_wait_for_wakeup();
+
+/**
+ *  Non-blocking version of mp_wait_for_wakeup. It returns 1 if an IPI was
+ *  pending (and acknowledged), 0 otherwise.
+ */
+int mp_poll_wakeup();
+
 #endif /* __MP_H__ */
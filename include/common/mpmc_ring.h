@@ -0,0 +1,91 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/mpmc_ring.h
+ *  @author Cesar Fuguet
+ *  @brief  Bounded lock-free multiple-producer/multiple-consumer ring buffer
+ *
+ *  Each cell of the ring has a sequence number telling whether it is ready to
+ *  be written (for a given lap) or read (D. Vyukov's bounded MPMC queue).
+ *  Producers and consumers claim positions with a CAS on the shared indexes.
+ *  The cells are provided by the caller. Their number shall be a power of 2.
+ *
+ *  Batched operations claim several consecutive positions at once. They may
+ *  wait for other CPUs that claimed the previous lap of these cells to
+ *  complete their operation.
+ *
+ *  If there is no hardware cache coherency, the data pointed by the popped
+ *  items shall be invalidated by the consumer.
+ */
+#ifndef __MPMC_RING_H__
+#define __MPMC_RING_H__
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include "common/cache.h"
+
+typedef struct mpmc_ring_cell_s
+{
+    atomic_ulong seq;
+    atomic_uintptr_t data;
+} mpmc_ring_cell_t;
+
+typedef struct mpmc_ring_s
+{
+    /* Next position to be written (producers) */
+    atomic_ulong head __cl_aligned__;
+
+    /* Next position to be read (consumers) */
+    atomic_ulong tail __cl_aligned__;
+
+    /* Read-only fields */
+    mpmc_ring_cell_t *cell __cl_aligned__;
+    unsigned long mask;
+} mpmc_ring_t;
+
+/**
+ *  Initializes the ring with size cells (power of 2). It returns 0 on
+ *  success, -1 if the size is not valid.
+ */
+int mpmc_ring_init(mpmc_ring_t *r, mpmc_ring_cell_t *cell, size_t size);
+
+/**
+ *  Pushes one item. It returns 0 on success, -1 if the ring is full.
+ */
+int mpmc_ring_push(mpmc_ring_t *r, void *item);
+
+/**
+ *  Pops one item. It returns 0 on success, -1 if the ring is empty.
+ */
+int mpmc_ring_pop(mpmc_ring_t *r, void **item);
+
+/**
+ *  Pushes up to n items. It returns the number of pushed items.
+ */
+size_t mpmc_ring_push_batch(mpmc_ring_t *r, void * const *items, size_t n);
+
+/**
+ *  Pops up to n items. It returns the number of popped items.
+ */
+size_t mpmc_ring_pop_batch(mpmc_ring_t *r, void **items, size_t n);
+
+static inline size_t mpmc_ring_size(mpmc_ring_t *r)
+{
+    return r->mask + 1;
+}
+
+#endif /* __MPMC_RING_H__ */
@@ -0,0 +1,95 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/parallel.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the fork-join routines used to distribute
+ *          loop iterations across all the CPUs of the platform
+ *
+ *  Iterations are executed by the workers of a thread pool (see
+ *  thread_pool.h), created on the first call, and by the calling CPU itself.
+ *  Parallel loops shall be called from a single director thread (no nesting).
+ */
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include "common/thread_pool.h"
+
+/*
+ *  Function executed for each chunk of iterations in [begin, end)
+ */
+typedef void (*parallel_for_func_t)(long begin, long end, void *args);
+
+enum parallel_sched_e {
+    /* One contiguous block of chunks per CPU */
+    PARALLEL_SCHED_STATIC = 0,
+
+    /* Chunks distributed cyclically among CPUs */
+    PARALLEL_SCHED_ROUND_ROBIN,
+
+    /* Chunks claimed on demand with an atomic counter */
+    PARALLEL_SCHED_DYNAMIC
+};
+
+/**
+ *  Creates the worker threads used by parallel loops. The flags are those of
+ *  thread_pool_init. Calling this function is optional: workers are created
+ *  with THREAD_POOL_WFI on the first parallel loop. Without THREAD_POOL_WFI,
+ *  idle workers poll their descriptor and keep their CPU busy between loops.
+ *
+ *  All the other CPUs are claimed if they are idle. Otherwise, only the idle
+ *  ones are. If no worker can be created, the initialization is retried on
+ *  the next call.
+ *
+ *  It returns the number of CPUs participating in parallel loops.
+ */
+int parallel_init(int flags);
+
+/**
+ *  Stops the worker threads used by parallel loops
+ */
+int parallel_fini();
+
+/**
+ *  Returns the number of CPUs participating in parallel loops
+ */
+int parallel_get_ncpus();
+
+/**
+ *  Sets the scheduling policy used by parallel_for
+ *  (by default, PARALLEL_SCHED_STATIC)
+ */
+void parallel_set_sched(enum parallel_sched_e sched);
+
+/**
+ *  Executes func on the iterations [begin, end) split in chunks of chunk
+ *  iterations (chunk <= 0 is handled as 1), using the default scheduling
+ *  policy.
+ *
+ *  It returns 0 on success, and -1 on failure of any worker.
+ */
+int parallel_for(long begin, long end, long chunk,
+        parallel_for_func_t func, void *args);
+
+/**
+ *  Same as parallel_for, but with an explicit scheduling policy
+ */
+int parallel_for_sched(enum parallel_sched_e sched,
+        long begin, long end, long chunk,
+        parallel_for_func_t func, void *args);
+
+#endif /* __PARALLEL_H__ */
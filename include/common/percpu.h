@@ -0,0 +1,73 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/percpu.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and macros used to define
+ *          per-CPU variables
+ *
+ *  Per-CPU variables are placed in the .percpu section. This section is a
+ *  template: at boot, one copy of it is allocated for each CPU in the cached
+ *  memory region. Copies start on their own cache line, so variables of
+ *  different CPUs never share a line.
+ *
+ *      static DEFINE_PER_CPU(int, counter);
+ *
+ *      this_cpu(counter)++;
+ *      int c = per_cpu(counter, 2);
+ *
+ *  If there is no hardware cache coherency, per-CPU variables accessed by
+ *  other CPUs shall be accessed with atomic operations (or cache maintenance
+ *  operations), as any other shared data.
+ */
+#ifndef __PERCPU_H__
+#define __PERCPU_H__
+
+#include <stdint.h>
+#include "bsp/bsp_config.h"
+#include "common/mp.h"
+
+#define DEFINE_PER_CPU(type, name) \
+    __attribute__((section(".percpu"))) __typeof__(type) per_cpu__##name
+
+#define DECLARE_PER_CPU(type, name) \
+    extern __attribute__((section(".percpu"))) __typeof__(type) per_cpu__##name
+
+/*
+ *  Offset between the template and the copy of each logical CPU. It is zero
+ *  before percpu_init (all CPUs use the template).
+ */
+extern uintptr_t __percpu_offset[BSP_CONFIG_NCPUS];
+
+/* Pointer to (and value of) the copy of the variable of the given CPU */
+#define per_cpu_ptr(name, cpu) \
+    ((__typeof__(&per_cpu__##name))((uintptr_t)&per_cpu__##name + \
+        __percpu_offset[(cpu)]))
+#define per_cpu(name, cpu) (*per_cpu_ptr(name, cpu))
+
+/* Pointer to (and value of) the copy of the variable of the executing CPU */
+#define this_cpu_ptr(name) per_cpu_ptr(name, mp_get_self_sid())
+#define this_cpu(name)     (*this_cpu_ptr(name))
+
+/**
+ *  Allocates and initializes the per-CPU copies of the .percpu section. It is
+ *  called once by the boot CPU. It returns 0 on success, -1 if there is not
+ *  enough memory.
+ */
+int percpu_init();
+
+#endif /* __PERCPU_H__ */
@@ -0,0 +1,69 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/rw_mutex.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          reader-writer mutexes
+ *
+ *  Multiple readers can hold the mutex concurrently. Writers have exclusive
+ *  access. With the writer preference, new readers wait when a writer is
+ *  waiting. With the reader preference, writers wait until there is no reader.
+ *
+ *  Each CPU announces its readers in its own cache line. Readers never write
+ *  a shared location, so they do not contend with each other. Writers scan
+ *  the reader slots of all the CPUs.
+ */
+#ifndef __RW_MUTEX_H__
+#define __RW_MUTEX_H__
+
+#include <stdatomic.h>
+#include "bsp/bsp_config.h"
+#include "common/cache.h"
+
+enum rw_mutex_pref_e {
+    RW_MUTEX_PREFER_WRITER = 0,
+    RW_MUTEX_PREFER_READER
+};
+
+typedef struct {
+    /* Number of readers of the CPU holding (or trying to hold) the mutex */
+    atomic_int count;
+} __cl_aligned__ rw_mutex_reader_t;
+
+typedef struct {
+    /* Non-zero when a writer holds the mutex */
+    atomic_int writer __cl_aligned__;
+
+    /* Number of writers waiting for the mutex (writer preference) */
+    atomic_int wwait;
+
+    enum rw_mutex_pref_e pref;
+
+    rw_mutex_reader_t reader[BSP_CONFIG_NCPUS];
+} rw_mutex_t;
+
+void rw_mutex_init(rw_mutex_t *m, enum rw_mutex_pref_e pref);
+void rw_mutex_destroy(rw_mutex_t *m);
+void rw_mutex_read_lock(rw_mutex_t *m);
+int rw_mutex_read_trylock(rw_mutex_t *m);
+void rw_mutex_read_unlock(rw_mutex_t *m);
+void rw_mutex_write_lock(rw_mutex_t *m);
+int rw_mutex_write_trylock(rw_mutex_t *m);
+void rw_mutex_write_unlock(rw_mutex_t *m);
+
+#endif /* __RW_MUTEX_H__ */
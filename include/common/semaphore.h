@@ -0,0 +1,44 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/semaphore.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          counting semaphores
+ *
+ *  Waiters sleep in low-power mode (WFI) while the count is zero.
+ */
+#ifndef __SEMAPHORE_H__
+#define __SEMAPHORE_H__
+
+#include <stdatomic.h>
+#include "common/cache.h"
+#include "common/waitq.h"
+
+typedef struct {
+    atomic_int count __cl_aligned__;
+    waitq_t waitq;
+} semaphore_t;
+
+void semaphore_init(semaphore_t *s, int count);
+void semaphore_destroy(semaphore_t *s);
+void semaphore_wait(semaphore_t *s);
+int semaphore_trywait(semaphore_t *s);
+void semaphore_post(semaphore_t *s);
+int semaphore_get_count(semaphore_t *s);
+
+#endif /* __SEMAPHORE_H__ */
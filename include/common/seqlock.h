@@ -0,0 +1,63 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/seqlock.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          sequence locks
+ *
+ *  Writers are serialized and increment the sequence number before and after
+ *  modifying the protected data (odd while a write is in progress). Readers
+ *  do not write any shared location: they read the data optimistically and
+ *  retry if the sequence number changed.
+ *
+ *  Usage on the reader side:
+ *
+ *      unsigned seq;
+ *      do {
+ *          seq = seqlock_read_begin(&s);
+ *          ... read the protected data ...
+ *      } while (seqlock_read_retry(&s, seq));
+ */
+#ifndef __SEQLOCK_H__
+#define __SEQLOCK_H__
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include "common/cache.h"
+
+typedef struct {
+    atomic_uint seq __cl_aligned__;
+
+    /* Protected data. If there is no hardware cache coherency, it is
+     * invalidated by readers at the beginning of each read section */
+    void *data;
+    size_t bytes;
+} seqlock_t;
+
+/**
+ *  Initializes the sequence lock. The data and bytes arguments describe the
+ *  protected memory region (data can be NULL).
+ */
+void seqlock_init(seqlock_t *s, void *data, size_t bytes);
+void seqlock_destroy(seqlock_t *s);
+void seqlock_write_lock(seqlock_t *s);
+void seqlock_write_unlock(seqlock_t *s);
+unsigned seqlock_read_begin(seqlock_t *s);
+int seqlock_read_retry(seqlock_t *s, unsigned seq);
+
+#endif /* __SEQLOCK_H__ */
@@ -0,0 +1,45 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/sleep_mutex.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          sleeping mutexes
+ *
+ *  Waiters spin for a short time and then sleep in low-power mode (WFI). The
+ *  CPU releasing the mutex wakes up one waiter with an inter-processor
+ *  interrupt.
+ */
+#ifndef __SLEEP_MUTEX_H__
+#define __SLEEP_MUTEX_H__
+
+#include <stdatomic.h>
+#include "common/cache.h"
+#include "common/waitq.h"
+
+typedef struct {
+    atomic_int lock __cl_aligned__;
+    waitq_t waitq;
+} sleep_mutex_t;
+
+void sleep_mutex_init(sleep_mutex_t *m);
+void sleep_mutex_destroy(sleep_mutex_t *m);
+void sleep_mutex_lock(sleep_mutex_t *m);
+int sleep_mutex_trylock(sleep_mutex_t *m);
+void sleep_mutex_unlock(sleep_mutex_t *m);
+
+#endif /* __SLEEP_MUTEX_H__ */
@@ -0,0 +1,93 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/spsc_ring.h
+ *  @author Cesar Fuguet
+ *  @brief  Bounded lock-free single-producer/single-consumer ring buffer
+ *
+ *  The ring stores pointers in a buffer provided by the caller. The number of
+ *  slots shall be a power of 2. Each side keeps a private copy of the index
+ *  of the other side, and only reads the shared one when the copy says that
+ *  the ring is full (producer) or empty (consumer).
+ *
+ *  If there is no hardware cache coherency, the data pointed by the popped
+ *  items shall be invalidated by the consumer.
+ */
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include "common/cache.h"
+
+typedef struct spsc_ring_s
+{
+    /* Shared indexes: published by the producer and the consumer */
+    atomic_ulong head __cl_aligned__;
+    atomic_ulong tail __cl_aligned__;
+
+    /* Private state of the producer */
+    struct {
+        unsigned long head;
+        unsigned long tail_cache;
+    } prod __cl_aligned__;
+
+    /* Private state of the consumer */
+    struct {
+        unsigned long tail;
+        unsigned long head_cache;
+    } cons __cl_aligned__;
+
+    /* Read-only fields */
+    atomic_uintptr_t *buf __cl_aligned__;
+    unsigned long mask;
+} spsc_ring_t;
+
+/**
+ *  Initializes the ring with a buffer of size slots (power of 2). It returns
+ *  0 on success, -1 if the size is not valid.
+ */
+int spsc_ring_init(spsc_ring_t *r, atomic_uintptr_t *buf, size_t size);
+
+/**
+ *  Pushes one item. It returns 0 on success, -1 if the ring is full.
+ */
+int spsc_ring_push(spsc_ring_t *r, void *item);
+
+/**
+ *  Pops one item. It returns 0 on success, -1 if the ring is empty.
+ */
+int spsc_ring_pop(spsc_ring_t *r, void **item);
+
+/**
+ *  Pushes up to n items. It returns the number of pushed items.
+ */
+size_t spsc_ring_push_batch(spsc_ring_t *r, void * const *items, size_t n);
+
+/**
+ *  Pops up to n items. It returns the number of popped items.
+ */
+size_t spsc_ring_pop_batch(spsc_ring_t *r, void **items, size_t n);
+
+size_t spsc_ring_count(spsc_ring_t *r);
+
+static inline size_t spsc_ring_size(spsc_ring_t *r)
+{
+    return r->mask + 1;
+}
+
+#endif /* __SPSC_RING_H__ */
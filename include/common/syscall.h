@@ -23,6 +23,8 @@
 
 #include <sys/stat.h>
 
+struct _reent;
+
 void *_sbrk(int incr);
 int _close(int file);
 int _fstat(int file, struct stat *st);
@@ -33,5 +35,7 @@ void _kill(int pid, int sig);
 int _getpid(void);
 int _write (int file, char * ptr, int len);
 int _read (int file, char * ptr, int len);
+void __malloc_lock(struct _reent *r);
+void __malloc_unlock(struct _reent *r);
 
 #endif
@@ -0,0 +1,91 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/task.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures of the
+ *          work-stealing task runtime
+ *
+ *  Each CPU owns a lock-free work-stealing deque (Chase-Lev). Spawned tasks
+ *  are pushed to the deque of the executing CPU. Idle CPUs steal tasks from
+ *  the top of the deque of randomly selected victims.
+ *
+ *  Task descriptors are provided by the caller and shall remain valid until
+ *  the task_sync on their group returns. If there is no hardware cache
+ *  coherency, data produced by tasks executed on other CPUs shall be
+ *  invalidated by the consumer after task_sync.
+ */
+#ifndef __TASK_H__
+#define __TASK_H__
+
+#include <stdatomic.h>
+#include "common/cache.h"
+#include "common/thread_pool.h"
+
+#ifndef TASK_DEQUE_SIZE
+#define TASK_DEQUE_SIZE 256    /* must be a power of 2 */
+#endif
+
+typedef void (*task_func_t)(void *args);
+
+typedef struct task_group_s
+{
+    /* Number of tasks of the group not yet completed */
+    atomic_long pending;
+} __cl_aligned__ task_group_t;
+
+typedef struct task_s
+{
+    task_func_t func;
+    void *args;
+    task_group_t *group;
+} task_t;
+
+typedef struct task_deque_s
+{
+    atomic_long top __cl_aligned__;
+    atomic_long bottom __cl_aligned__;
+    atomic_uintptr_t buf[TASK_DEQUE_SIZE] __cl_aligned__;
+} task_deque_t;
+
+/**
+ *  Starts the worker threads of the task runtime. The flags are those of
+ *  thread_pool_init. If the task runtime is not started, tasks are executed
+ *  by the spawning CPU only.
+ */
+int task_runtime_init(int flags);
+
+/**
+ *  Stops the worker threads of the task runtime
+ */
+int task_runtime_fini();
+
+void task_group_init(task_group_t *g);
+
+/**
+ *  Spawns a new task in the given group. When the deque of the executing CPU
+ *  is full, the task is executed immediately.
+ */
+void task_spawn(task_group_t *g, task_t *t, task_func_t func, void *args);
+
+/**
+ *  Waits for the completion of all the tasks of the group. The executing CPU
+ *  runs (or steals) pending tasks while waiting.
+ */
+void task_sync(task_group_t *g);
+
+#endif /* __TASK_H__ */
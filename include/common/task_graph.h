@@ -0,0 +1,150 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/task_graph.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to execute
+ *          graphs of tasks with static dependencies
+ *
+ *  Nodes and edges are declared once, then the graph can be executed many
+ *  times. Node and edge descriptors are provided by the caller (no dynamic
+ *  allocation).
+ *
+ *  On each execution, every node has an atomic counter of the predecessors
+ *  not yet completed. Nodes with no predecessors are distributed among the
+ *  ready queues of the participating CPUs (the caller and the workers of a
+ *  thread pool). When a node completes, each successor whose counter reaches
+ *  zero is pushed to the ready queue of the CPU that completed it. Idle CPUs
+ *  steal ready nodes from the queues of the other participants.
+ *
+ *  If there is no hardware cache coherency, data produced by a node and
+ *  consumed by its successors shall be invalidated by the consumer.
+ */
+#ifndef __TASK_GRAPH_H__
+#define __TASK_GRAPH_H__
+
+#include <stdatomic.h>
+#include "common/cache.h"
+#include "common/mpmc_ring.h"
+#include "common/thread_pool.h"
+
+#ifndef TASK_GRAPH_QUEUE_SIZE
+#define TASK_GRAPH_QUEUE_SIZE 64    /* must be a power of 2 */
+#endif
+
+typedef void (*task_graph_func_t)(void *args);
+
+typedef struct task_graph_node_s
+{
+    task_graph_func_t func;
+    void *args;
+
+    /* Number of predecessors */
+    int npreds;
+
+    /* First outgoing edge (-1 if none) */
+    int first_edge;
+
+    /* Private field used to check the graph */
+    int link;
+
+    /* Number of predecessors not yet completed in the current execution */
+    atomic_int pending;
+} __cl_aligned__ task_graph_node_t;
+
+typedef struct task_graph_edge_s
+{
+    /* Destination node */
+    int to;
+
+    /* Next outgoing edge of the same source node (-1 if none) */
+    int next;
+} task_graph_edge_t;
+
+typedef struct task_graph_rank_s
+{
+    struct task_graph_s *graph;
+    int rank;
+} __cl_aligned__ task_graph_rank_t;
+
+typedef struct task_graph_s
+{
+    task_graph_node_t *node;
+    int nnodes;
+    int max_nodes;
+
+    task_graph_edge_t *edge;
+    int nedges;
+    int max_edges;
+
+    /* Number of CPUs participating in the current execution */
+    int nranks;
+
+    /* Non-zero when the graph was checked to be acyclic */
+    int checked;
+
+    /* Number of nodes not yet completed in the current execution */
+    atomic_int remaining __cl_aligned__;
+
+    task_graph_rank_t rank[BSP_CONFIG_NCPUS];
+
+    /* Ready queues (one per participating CPU) */
+    mpmc_ring_t queue[BSP_CONFIG_NCPUS];
+    mpmc_ring_cell_t cell[BSP_CONFIG_NCPUS][TASK_GRAPH_QUEUE_SIZE] __cl_aligned__;
+} task_graph_t;
+
+/**
+ *  Initializes an empty graph with storage for max_nodes nodes and max_edges
+ *  edges. It returns 0 on success, -1 if the arguments are not valid.
+ */
+int task_graph_init(task_graph_t *g, task_graph_node_t *node, int max_nodes,
+        task_graph_edge_t *edge, int max_edges);
+
+/**
+ *  Removes all the nodes and edges of the graph
+ */
+void task_graph_reset(task_graph_t *g);
+
+/**
+ *  Adds a node to the graph. It returns the identifier of the node, or -1 if
+ *  there is no room for it.
+ */
+int task_graph_add_node(task_graph_t *g, task_graph_func_t func, void *args);
+
+/**
+ *  Adds a dependency: the node to is executed after the completion of the
+ *  node from. It returns 0 on success, -1 if there is no room for the edge or
+ *  the nodes are not valid.
+ */
+int task_graph_add_edge(task_graph_t *g, int from, int to);
+
+/**
+ *  Executes all the nodes of the graph in dependency order, and waits for
+ *  their completion. The calling CPU and the workers of the given pool (may
+ *  be NULL) execute the nodes. The pool shall not be used by others during
+ *  the execution.
+ *
+ *  It returns 0 on success, -1 if the graph has a cycle or a worker failed.
+ */
+int task_graph_run(task_graph_t *g, thread_pool_t *pool);
+
+static inline int task_graph_size(task_graph_t *g)
+{
+    return g->nnodes;
+}
+
+#endif /* __TASK_GRAPH_H__ */
@@ -0,0 +1,124 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/thread_pool.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          a pool of persistent worker threads
+ *
+ *  Worker threads are created once (with thread_create) and stay resident in
+ *  a dispatch loop. Submitting a work item to a worker only requires to write
+ *  its descriptor and to increment a sequence number (and optionally to send a
+ *  wake-up IPI when workers sleep in WFI).
+ */
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <stdatomic.h>
+#include "common/cache.h"
+#include "common/mp.h"
+#include "common/threads.h"
+
+/*
+ *  Thread pool flags
+ */
+#define THREAD_POOL_WFI  (1 << 0)  /* idle workers wait in low-power mode */
+
+typedef struct thread_pool_worker_s
+{
+    /* Dispatch sequence number. Incremented by the director on submit */
+    atomic_uint seq;
+
+    /* Completion sequence number. Written by the worker after execution */
+    atomic_uint done;
+
+    /* Work item: function and arguments */
+    atomic_uintptr_t func;
+    atomic_uintptr_t args;
+
+    /* Return status of the last work item */
+    atomic_int status;
+
+    /* Private fields of the director thread */
+    unsigned int next;
+    int flags;
+    int cpu_id;
+    thread_t thread;
+} __cl_aligned__ thread_pool_worker_t;
+
+typedef struct thread_pool_s
+{
+    thread_pool_worker_t worker[BSP_CONFIG_NCPUS];
+    int nworkers;
+    int flags;
+} thread_pool_t;
+
+/**
+ *  Creates a pool of nworkers persistent worker threads. If nworkers is
+ *  negative, one worker is created in each CPU other than the calling one
+ *  (mp_get_cpu_count() - 1 workers).
+ *
+ *  It returns 0 on success, and -1 when the workers cannot be created (e.g.
+ *  one of the CPUs is busy). In that case, no worker is left running.
+ */
+int thread_pool_init(thread_pool_t *pool, int nworkers, int flags);
+
+/**
+ *  Stops and joins all the workers of the pool
+ */
+int thread_pool_destroy(thread_pool_t *pool);
+
+/**
+ *  Submits a work item to the given worker of the pool. If the worker is still
+ *  executing a previous work item, it waits for its completion first.
+ */
+int thread_pool_submit(thread_pool_t *pool, int worker,
+        cpu_entry_func_t func, void *args);
+
+/**
+ *  Submits the same work item to all the workers of the pool
+ */
+int thread_pool_submit_all(thread_pool_t *pool,
+        cpu_entry_func_t func, void *args);
+
+/**
+ *  Returns 1 if the given worker has completed its last work item, 0 if not,
+ *  and -1 if the worker is not valid
+ */
+int thread_pool_is_done(thread_pool_t *pool, int worker);
+
+/**
+ *  Waits for the completion of the last work item of the given worker, and
+ *  returns its status
+ */
+int thread_pool_wait(thread_pool_t *pool, int worker);
+
+/**
+ *  Waits for the completion of all the workers. It returns THREAD_FAILURE if
+ *  any of them failed.
+ */
+int thread_pool_wait_all(thread_pool_t *pool);
+
+/**
+ *  Returns the number of workers in the pool
+ */
+static inline int thread_pool_size(thread_pool_t *pool)
+{
+    return pool->nworkers;
+}
+
+#endif /* __THREAD_POOL_H__ */
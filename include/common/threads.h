@@ -28,6 +28,16 @@
 #define THREAD_SUCCESS  0
 #define THREAD_FAILURE -1
 
+/*
+ *  Thread flags
+ */
+#define THREAD_JOIN_WFI  (1 << 0)  /* the joiner waits in low-power mode */
+
+/*
+ *  Value of the init field of a thread structure initialized by thread_init
+ */
+#define THREAD_INIT_MAGIC 0x74687264U
+
 typedef struct thread_s
 {
     /* On exit of the thread_create routine, it contains the ID of the thread */
@@ -36,18 +46,75 @@ typedef struct thread_s
     /* If cpu_id != NULL, specifies the logical ID of the target CPU */
     void *cpu_id;
 
+    /* If cpu_id == NULL, set of the candidate CPUs (all if empty) */
+    cpuset_t cpuset;
+
+    /* If cpu_id == NULL, policy used to select a free CPU in cpuset */
+    enum mp_placement_e placement;
+
     /* On exit of the thread create routing, it contains the pointer to the CPU
      * description structure */
     cpu_t *desc;
 
-    /* Can be used by the thread to return something to the director thread
-     * when this last calls thread_join */
+    /* On exit of the thread_join routine, it contains the return status of
+     * the entry function (cast to a pointer) */
     void *ret;
+
+    /* Thread flags (THREAD_JOIN_WFI) */
+    int flags;
+
+    /* THREAD_INIT_MAGIC if the structure was initialized by thread_init.
+     * Otherwise, only cpu_id is read, and the other attributes take their
+     * default values. */
+    uint32_t init;
+
+    /* Completion word: 0 while running, the logical ID + 1 of the CPU
+     * waiting in thread_join with THREAD_JOIN_WFI, or -1 once the entry
+     * function returned */
+    atomic_int done;
 } thread_t;
 
+/**
+ *  Initializes the thread structure with default attributes: any CPU, first
+ *  free one, no flags. It shall be called before setting the cpuset,
+ *  placement and flags attributes. Without it, thread_create and
+ *  thread_create_group only read cpu_id, and ignore the other attributes.
+ */
+void thread_init(thread_t *t);
+
 int thread_create(thread_t *t, cpu_entry_func_t func, void *args);
+
+/**
+ *  Creates n threads executing the same entry function. The thread i
+ *  receives args[i] (NULL if args is NULL). Thread structures are placed
+ *  like in thread_create, and each thread gets a different CPU.
+ *
+ *  All the CPU descriptors are written first, then the IPIs are sent
+ *  back-to-back, and the wake-up of all the threads is awaited at once. It
+ *  returns 0 on success, -1 if there are not enough free CPUs or a thread
+ *  failed to start, and -2 on timeout. On failure, no thread of the group
+ *  runs: the CPUs already awake go back to IDLE.
+ */
+int thread_create_group(thread_t *t, int n, cpu_entry_func_t func,
+        void * const *args);
 int thread_destroy(thread_t *t);
-int thread_join(thread_t *t);
 int thread_id();
 
+/**
+ *  Waits for the entry function of the thread to return. The joiner polls
+ *  the completion word of the thread, or waits in low-power mode until the
+ *  thread sends it an IPI (THREAD_JOIN_WFI flag). There is no timeout.
+ *
+ *  It returns 0 on success, and -1 if the entry function returned
+ *  THREAD_FAILURE. Its return status is copied into t->ret.
+ */
+int thread_join(thread_t *t);
+
+/**
+ *  Publishes the completion of the thread with the given status of the entry
+ *  function, and wakes up its joiner. It is called by the start routine of
+ *  secondary CPUs.
+ */
+void thread_signal_exit(thread_t *t, int status);
+
 #endif /* __THREADS_H__ */
@@ -0,0 +1,61 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/tls.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines used to manage the thread-local
+ *          storage (TLS) of the CPUs
+ *
+ *  Each CPU has its own TLS block, and the thread pointer register (tp)
+ *  points to it. Thus, __thread (C) and thread_local (C++) variables can be
+ *  used. The layout of the block follows the RISC-V ABI (local-exec model):
+ *  the .tdata section followed by the .tbss section.
+ *
+ *  The blocks of all CPUs are allocated at boot, in the cached memory
+ *  region, and each block starts on its own cache line. A block is
+ *  reinitialized (from the .tdata template) each time a thread is launched
+ *  on its CPU.
+ */
+#ifndef __TLS_H__
+#define __TLS_H__
+
+#include <stddef.h>
+
+/**
+ *  Allocates the TLS blocks of all CPUs. It is called once by the boot CPU.
+ *  It returns 0 on success, -1 if there is not enough memory.
+ */
+int tls_init();
+
+/**
+ *  Initializes the TLS block of the given CPU, and points the thread pointer
+ *  of the executing CPU to it
+ */
+void tls_enter(int cpu_id);
+
+/**
+ *  Returns the TLS block of the given CPU (NULL if there are no
+ *  thread-local variables)
+ */
+void* tls_get_block(int cpu_id);
+
+/**
+ *  Returns the size in bytes of a TLS block
+ */
+size_t tls_get_size();
+
+#endif /* __TLS_H__ */
@@ -0,0 +1,184 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/uthread.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to manage
+ *          cooperative user-level threads
+ *
+ *  User-level threads are multiplexed on the CPU creating them. Each CPU has
+ *  its own run queue. The thread initially running on the CPU (e.g. main or
+ *  the entry function of a thread_t) is itself a user-level thread.
+ *
+ *  By default, scheduling is cooperative: a thread runs until it yields,
+ *  sleeps or exits. When preemption is enabled (uthread_preempt_enable), the
+ *  CLINT timer interrupt of the CPU also switches between ready threads with
+ *  the same priority (round-robin). Ready threads with a higher priority
+ *  always run first. A preempted thread keeps its floating-point registers,
+ *  fcsr and vector state (when the vector extension is enabled).
+ *
+ *  A new thread starts with the interrupt enable state (MIE) of its creator.
+ *
+ *  Threads and stacks are provided by the caller and shall remain valid until
+ *  uthread_join returns.
+ */
+#ifndef __UTHREAD_H__
+#define __UTHREAD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bsp/bsp_config.h"
+#include "common/cache.h"
+
+#ifndef UTHREAD_STACK_MIN
+#define UTHREAD_STACK_MIN 1024
+#endif
+
+/*
+ *  Priority levels: from 0 (lowest and default) to UTHREAD_NPRIO-1
+ */
+#ifndef UTHREAD_NPRIO
+#define UTHREAD_NPRIO 4
+#endif
+
+/*
+ *  Preemption flags
+ */
+#define UTHREAD_TICKLESS  (1 << 0)  /* no tick when no other thread is ready */
+
+typedef void (*uthread_func_t)(void *args);
+
+enum uthread_state_e {
+    UTHREAD_READY = 0,
+    UTHREAD_RUNNING,
+    UTHREAD_SLEEPING,
+    UTHREAD_BLOCKED,
+    UTHREAD_DONE
+};
+
+typedef struct uthread_s
+{
+    /* Saved stack pointer (the switch frame is on top of the stack) */
+    uintptr_t sp;
+
+    enum uthread_state_e state;
+    int prio;
+    uthread_func_t func;
+    void *args;
+
+    /* Wake-up time (cycles) of a sleeping thread */
+    uint64_t wakeup;
+
+    /* Next thread in the run queue or sleep queue */
+    struct uthread_s *next;
+
+    /* Thread blocked in uthread_join on this one */
+    struct uthread_s *joiner;
+} uthread_t;
+
+typedef struct uthread_queue_s
+{
+    uthread_t *head;
+    uthread_t *tail;
+} uthread_queue_t;
+
+/*
+ *  Per-CPU scheduler. It is only accessed by its CPU.
+ */
+typedef struct uthread_sched_s
+{
+    int initialized;
+    uthread_t *current;
+    uthread_queue_t ready[UTHREAD_NPRIO];
+    uthread_queue_t sleeping;
+
+    /* Preemption: enabled, flags and tick period (CLINT timer ticks) */
+    int preempt;
+    int flags;
+    uintptr_t period;
+
+    /* Interrupt enable state of the CPU before enabling the preemption */
+    uintptr_t saved_mie;
+
+    /* Thread initially running on the CPU */
+    uthread_t main;
+} __cl_aligned__ uthread_sched_t;
+
+/**
+ *  Creates a new thread on the executing CPU. It returns 0 on success, -1 if
+ *  the stack is too small.
+ */
+int uthread_create(uthread_t *t, uthread_func_t func, void *args,
+        void *stack, size_t stack_bytes);
+
+/**
+ *  Sets the priority of a thread. It takes effect at the next scheduling
+ *  point. It returns 0 on success, -1 if the priority is not valid.
+ */
+int uthread_set_priority(uthread_t *t, int prio);
+
+/**
+ *  Gives the CPU to the next ready thread with the same or higher priority
+ *  (if any)
+ */
+void uthread_yield();
+
+/**
+ *  Suspends the executing thread during (at least) the given number of cycles
+ */
+void uthread_sleep(uint64_t cycles);
+
+/**
+ *  Terminates the executing thread. Returning from the thread function is
+ *  equivalent.
+ */
+void uthread_exit() __attribute__((noreturn));
+
+/**
+ *  Waits for the termination of the given thread. Only one thread, of the
+ *  same CPU, can wait for a given thread.
+ */
+void uthread_join(uthread_t *t);
+
+/**
+ *  Returns the executing thread
+ */
+uthread_t* uthread_self();
+
+/**
+ *  Enables the preemption of the user-level threads of the executing CPU.
+ *  The period is given in CLINT timer ticks. With the UTHREAD_TICKLESS flag,
+ *  the timer is only armed when another thread is ready or sleeping.
+ *  It enables the timer interrupt and the global interrupts of the CPU.
+ */
+void uthread_preempt_enable(uintptr_t period, int flags);
+
+/**
+ *  Disables the preemption of the user-level threads of the executing CPU.
+ *  The global interrupts are restored to their state before
+ *  uthread_preempt_enable.
+ */
+void uthread_preempt_disable();
+
+/**
+ *  Discards the user-level threads left by a previous thread of the
+ *  executing CPU and disables their preemption. The scheduler is initialized
+ *  again on its next use. It is called by the BSP when a thread is launched.
+ */
+void uthread_sched_reset();
+
+#endif /* __UTHREAD_H__ */
@@ -0,0 +1,94 @@
+/**
+ * Copyright 2023,2024 CEA*
+ * Commissariat a l'Energie Atomique et aux Energies Alternatives
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/**
+ *  @file   include/common/waitq.h
+ *  @author Cesar Fuguet
+ *  @brief  This file describes the routines and structures used to park CPUs
+ *          in low-power mode (WFI) until they are woken by another CPU
+ *
+ *  Each CPU has a slot in the wait queue. Waiters shall use the following
+ *  sequence to avoid losing wake-ups:
+ *
+ *      for (;;) {
+ *          if (condition) break;
+ *          waitq_prepare(&q);
+ *          if (condition) { waitq_cancel(&q); break; }
+ *          waitq_wait(&q);
+ *      }
+ *
+ *  Wakers shall make the condition true before calling waitq_wake_one or
+ *  waitq_wake_all. Woken CPUs receive a CPU_IPI_WAKEUP inter-processor
+ *  interrupt (see mp_wakeup_cpu).
+ */
+#ifndef __WAITQ_H__
+#define __WAITQ_H__
+
+#include <stdatomic.h>
+#include "bsp/bsp_config.h"
+#include "common/cache.h"
+
+enum waitq_state_e {
+    WAITQ_IDLE = 0,
+    WAITQ_WAITING,
+    WAITQ_NOTIFIED
+};
+
+typedef struct {
+    atomic_int state;
+} __cl_aligned__ waitq_slot_t;
+
+typedef struct {
+    /* Number of waiting CPUs. It allows wakers to skip the scan of slots */
+    atomic_int nwaiters __cl_aligned__;
+
+    /* First slot to scan on the next wake-up (fairness) */
+    atomic_int next;
+
+    waitq_slot_t slot[BSP_CONFIG_NCPUS];
+} waitq_t;
+
+void waitq_init(waitq_t *q);
+void waitq_destroy(waitq_t *q);
+
+/**
+ *  Registers the executing CPU as waiter
+ */
+void waitq_prepare(waitq_t *q);
+
+/**
+ *  Unregisters the executing CPU (when the condition became true between
+ *  waitq_prepare and waitq_wait)
+ */
+void waitq_cancel(waitq_t *q);
+
+/**
+ *  Puts the executing CPU in low-power mode until it is woken up. It shall be
+ *  preceded by waitq_prepare.
+ */
+void waitq_wait(waitq_t *q);
+
+/**
+ *  Wakes up one waiting CPU. It returns 1 if a CPU was woken up, 0 otherwise.
+ */
+int waitq_wake_one(waitq_t *q);
+
+/**
+ *  Wakes up all the waiting CPUs. It returns the number of woken CPUs.
+ */
+int waitq_wake_all(waitq_t *q);
+
+#endif /* __WAITQ_H__ */